@@ -2,28 +2,61 @@
  * @file ItemsDB.h
  * @brief Predefined items database
  *
- * This file contains static shared pointers to predefined items that can be
+ * This file contains shared pointers to predefined items that can be
  * used in the game. All items are created using make_shared for proper
- * memory management.
+ * memory management. The variables are inline so every source file shares
+ * the same item objects, and each item's position in ItemCatalogue is its
+ * id when games or board pages are written to disk.
  *
  * @author [Onuchi Kalu, 25052624]
  */
 #pragma once
 #include "items.hpp"
 #include <memory>
+#include <vector>
 
 // Predefined weapons
-static std::shared_ptr<Weapon> Sword = std::make_shared<Weapon>("Sword", 10, 10);
-static std::shared_ptr<Weapon> Dagger = std::make_shared<Weapon>("Dagger", 5, 5);
+inline std::shared_ptr<Weapon> Sword = std::make_shared<Weapon>("Sword", 10, 10);
+inline std::shared_ptr<Weapon> Dagger = std::make_shared<Weapon>("Dagger", 5, 5);
 
 // Predefined armor
-static std::shared_ptr<Armour> PlateArmor = std::make_shared<Armour>("Plate Armor", 40, 10, 5);
-static std::shared_ptr<Armour> LeatherArmor = std::make_shared<Armour>("Leather Armor", 20, 5, 0);
+inline std::shared_ptr<Armour> PlateArmor = std::make_shared<Armour>("Plate Armor", 40, 10, 5);
+inline std::shared_ptr<Armour> LeatherArmor = std::make_shared<Armour>("Leather Armor", 20, 5, 0);
 
 // Predefined shields
-static std::shared_ptr<Shield> LargeShield = std::make_shared<Shield>("Large Shield", 30, 10, 5);
-static std::shared_ptr<Shield> SmallShield = std::make_shared<Shield>("Small Shield", 10, 5, 0);
+inline std::shared_ptr<Shield> LargeShield = std::make_shared<Shield>("Large Shield", 30, 10, 5);
+inline std::shared_ptr<Shield> SmallShield = std::make_shared<Shield>("Small Shield", 10, 5, 0);
 
 // Predefined rings
-static std::shared_ptr<Ring> RingOfLife = std::make_shared<Ring>("Ring of Life", 1, 10, 0);
-static std::shared_ptr<Ring> RingOfStrength = std::make_shared<Ring>("Ring of Strength", 1, -10, 50);
+inline std::shared_ptr<Ring> RingOfLife = std::make_shared<Ring>("Ring of Life", 1, 10, 0);
+inline std::shared_ptr<Ring> RingOfStrength = std::make_shared<Ring>("Ring of Strength", 1, -10, 50);
+
+// Every predefined item; the index is the item id used in saved data.
+// Only append to this list so existing ids keep their meaning.
+inline const std::vector<std::shared_ptr<Item>> ItemCatalogue = {
+    Sword, Dagger, PlateArmor, LeatherArmor, LargeShield, SmallShield, RingOfLife, RingOfStrength
+};
+
+/**
+ * @brief Look up the id of a predefined item
+ *
+ * @param item Item to look up
+ * @return Index in ItemCatalogue, or -1 if the item is not predefined
+ */
+inline int itemId(const std::shared_ptr<Item>& item) {
+    for (size_t i = 0; i < ItemCatalogue.size(); i++) {
+        if (ItemCatalogue[i] == item) return (int)i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Look up a predefined item by id
+ *
+ * @param id Index in ItemCatalogue
+ * @return The item, or nullptr if the id is out of range
+ */
+inline std::shared_ptr<Item> itemById(int id) {
+    if (id < 0 || id >= (int)ItemCatalogue.size()) return nullptr;
+    return ItemCatalogue[id];
+}
@@ -0,0 +1,71 @@
+/**
+ * @file bench.hpp
+ * @brief Helpers shared by the microbenchmarks
+ *
+ * This file contains what the benchmark files need to set up games the
+ * way newGame() does, but at any size: characters of a given race, item
+ * lists of any length and populated boards. Benchmarks of printing code
+ * wrap themselves in QuietOutput (nullsink.hpp).
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <benchmark/benchmark.h>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <board.hpp>
+#include <characters.hpp>
+#include <ItemsDB.h>
+#include <random.hpp>
+#include <nullsink.hpp>
+
+using namespace std;
+
+/**
+ * @brief Create a character of a race from the race menu
+ *
+ * @param race 1 = Human, 2 = Elf, 3 = Dwarf, 4 = Hobbit, 5 = Orc
+ * @param name Character's name
+ * @return New character (a Human for any other number)
+ */
+inline shared_ptr<Character> makeCharacter(int race, const string& name) {
+    switch (race) {
+    case 2: return make_shared<Elf>(name);
+    case 3: return make_shared<Dwarf>(name);
+    case 4: return make_shared<Hobbit>(name);
+    case 5: return make_shared<Orc>(name);
+    default: return make_shared<Human>(name);
+    }
+}
+
+/**
+ * @brief Enemies of every race in turn, like newGame() uses but any number
+ */
+inline vector<shared_ptr<Character>> makeEnemies(int count) {
+    vector<shared_ptr<Character>> enemies;
+    for (int i = 0; i < count; i++) enemies.push_back(makeCharacter(i % 5 + 1, "Enemy"));
+    return enemies;
+}
+
+/**
+ * @brief Items from the catalogue in turn, any number
+ */
+inline vector<shared_ptr<Item>> makeItems(int count) {
+    vector<shared_ptr<Item>> items;
+    for (int i = 0; i < count; i++) items.push_back(ItemCatalogue[i % ItemCatalogue.size()]);
+    return items;
+}
+
+/**
+ * @brief A size x size board populated with entities enemies and items
+ *
+ * Uses a fixed random state, so every run benchmarks the same board.
+ * entities must leave free squares (populateBoard() retries until it finds one).
+ */
+inline unique_ptr<Board> makePopulatedBoard(int size, int entities) {
+    gameRandom().state = 1;
+    auto board = make_unique<Board>(size, size);
+    board->populateBoard(makeEnemies(entities), makeItems(entities));
+    return board;
+}
@@ -0,0 +1,42 @@
+# Microbenchmarks of the game code, built with Google Benchmark
+# (https://github.com/google/benchmark, e.g. the libbenchmark-dev package).
+#
+#   qmake bench.pro && make && ./bench
+#
+# Machine-readable results for tracking regressions:
+#   ./bench --benchmark_out=results.json --benchmark_out_format=json
+# (csv is also accepted). --benchmark_filter=PrintBoard runs a subset.
+
+TEMPLATE = app
+TARGET = bench
+CONFIG += console c++17 release thread
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += ..
+
+SOURCES += \
+        board_bench.cpp \
+        character_bench.cpp \
+        events_bench.cpp \
+        ../board.cpp \
+        ../characters.cpp \
+        ../counters.cpp \
+        ../events.cpp \
+        ../game.cpp \
+        ../interned.cpp \
+        ../journal.cpp \
+        ../keyboard.cpp \
+        ../pager.cpp \
+        ../serialize.cpp \
+        ../snapshot.cpp \
+        ../spatial.cpp \
+        ../spawn.cpp \
+        ../terrain.cpp \
+        ../timing.cpp
+
+HEADERS += \
+    bench.hpp
+
+LIBS += -lbenchmark_main -lbenchmark -lpthread
+win32: LIBS += -lshlwapi
@@ -0,0 +1,221 @@
+/**
+ * @file board_bench.cpp
+ * @brief Microbenchmarks of the board
+ *
+ * Board creation, populateBoard(), generating a whole board on 1-8
+ * threads, growing its caves and sampling its spawn points, printBoard()
+ * into a null sink, the day/night sweep over the enemies, and
+ * nearest-enemy queries through the spatial index against a scan of
+ * every square. Arguments are the board size (squares per side) and,
+ * where it matters, the number of enemies and of items placed.
+ *
+ * @author [Ish Soundankar]
+ */
+#include "bench.hpp"
+#include <cstdlib>
+#include <spawn.hpp>
+#include <terrain.hpp>
+
+/**
+ * @brief Board sizes crossed with entity counts that leave room on the board
+ */
+static void sizesAndEntities(benchmark::internal::Benchmark* b) {
+    for (int size : {64, 256, 1024}) {
+        for (int entities : {16, 256, 4096}) {
+            if (2 * entities <= size * size / 4) b->Args({size, entities});
+        }
+    }
+}
+
+/**
+ * @brief Create a board and allocate all of its chunks
+ *
+ * Chunks are allocated on first access, so construction alone costs
+ * nothing; this touches one square of every chunk as the first
+ * populateBoard() or printBoard() would.
+ */
+static void BM_BoardCreate(benchmark::State& state) {
+    int size = (int)state.range(0);
+    for (auto _ : state) {
+        Board board(size, size);
+        for (int row = 0; row < size; row += Chunk::SIZE) {
+            for (int column = 0; column < size; column += Chunk::SIZE) {
+                benchmark::DoNotOptimize(&board.at(row, column));
+            }
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t)((size + Chunk::SIZE - 1) / Chunk::SIZE) *
+                            ((size + Chunk::SIZE - 1) / Chunk::SIZE) * (int64_t)sizeof(Chunk));
+}
+BENCHMARK(BM_BoardCreate)->RangeMultiplier(4)->Range(64, 1024)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Place enemies and items on a board whose chunks already exist
+ */
+static void BM_PopulateBoard(benchmark::State& state) {
+    int size = (int)state.range(0);
+    auto enemies = makeEnemies((int)state.range(1));
+    auto items = makeItems((int)state.range(1));
+    gameRandom().state = 1;
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto board = make_unique<Board>(size, size);
+        for (int row = 0; row < size; row += Chunk::SIZE) {
+            for (int column = 0; column < size; column += Chunk::SIZE) board->at(row, column);
+        }
+        state.ResumeTiming();
+
+        board->populateBoard(enemies, items);
+
+        state.PauseTiming();
+        board.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * 2 * state.range(1));
+}
+BENCHMARK(BM_PopulateBoard)->Apply(sizesAndEntities)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Generate a whole bounded board from a seed; arguments are the size and the thread count
+ *
+ * Wall time, since the work is spread over threads. The board is the same
+ * for every thread count, so the times compare directly.
+ */
+static void BM_GenerateBoard(benchmark::State& state) {
+    int size = (int)state.range(0);
+    for (auto _ : state) {
+        auto board = make_unique<Board>(size, size);
+        board->generate(1, (int)state.range(1));
+
+        state.PauseTiming();
+        board.reset();
+        state.ResumeTiming();
+    }
+    int64_t chunkRows = (size + Chunk::SIZE - 1) / Chunk::SIZE;
+    state.SetItemsProcessed(state.iterations() * chunkRows * chunkRows);
+}
+BENCHMARK(BM_GenerateBoard)->ArgsProduct({{1024, 4096}, {1, 2, 4, 8}})->UseRealTime()->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Grow the caves of a size x size board: argument 1 = scatter and automaton steps only, 2 = also connect
+ */
+static void BM_CaveMap(benchmark::State& state) {
+    int size = (int)state.range(0);
+    CaveMap caves(size, size);
+    for (auto _ : state) {
+        caves.scatter(1);
+        for (int i = 0; i < CaveMap::STEPS; i++) caves.step();
+        if (state.range(1) == 2) caves.connect({0, 0});
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)size * size);
+    state.SetLabel(state.range(1) == 2 ? "connected" : "steps");
+}
+BENCHMARK(BM_CaveMap)->ArgsProduct({{1024, 4096}, {1, 2}})->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Lay Poisson-disk spawn points over the caves of a size x size board; argument 2 is the spacing
+ *
+ * The cave map is grown once; each iteration blocks its walls and the
+ * squares around the start (distance transform) and samples the rest.
+ */
+static void BM_SpawnSample(benchmark::State& state) {
+    int size = (int)state.range(0);
+    CaveMap caves(size, size);
+    caves.generate(1, {0, 0});
+    SpawnSampler sampler(size, size);
+    GameRandom random(1);
+    vector<Position> points;
+    for (auto _ : state) {
+        sampler.blocked = caves.walls;
+        sampler.keepClear({{0, 0}}, SpawnRules().startClearance);
+        sampler.sample((int)state.range(1), random, points);
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)size * size);
+    state.counters["points"] = (double)points.size();
+}
+BENCHMARK(BM_SpawnSample)->ArgsProduct({{1024, 4096}, {3, 12}})->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Print the window around the middle of the board, with fog of war off or on
+ */
+static void BM_PrintBoard(benchmark::State& state) {
+    int size = (int)state.range(0);
+    auto board = makePopulatedBoard(size, (int)state.range(1));
+    board->fogOfWar = state.range(2) != 0;
+    Position center = {size / 2, size / 2};
+    board->updateFieldOfView(center);
+    QuietOutput quiet;
+    for (auto _ : state) {
+        board->printBoard(center);
+    }
+}
+BENCHMARK(BM_PrintBoard)->ArgsProduct({{64, 1024}, {256}, {0, 1}});
+
+/**
+ * @brief Switch the board between day and night (updates every Orc)
+ */
+static void BM_DayNightSweep(benchmark::State& state) {
+    auto board = makePopulatedBoard((int)state.range(0), (int)state.range(1));
+    bool night = false;
+    for (auto _ : state) {
+        night = !night;
+        board->setTimeOfDay(night);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_DayNightSweep)->Apply(sizesAndEntities);
+
+/**
+ * @brief Query points spread over a board, the same for every benchmark
+ */
+static vector<Position> queryPoints(int size) {
+    GameRandom random(7);
+    vector<Position> points(256);
+    for (Position& p : points) p = {random.nextInt(size), random.nextInt(size)};
+    return points;
+}
+
+/**
+ * @brief Nearest enemy through the spatial index
+ */
+static void BM_NearestIndex(benchmark::State& state) {
+    int size = (int)state.range(0);
+    auto board = makePopulatedBoard(size, (int)state.range(1));
+    vector<Position> points = queryPoints(size);
+    size_t next = 0;
+    for (auto _ : state) {
+        Position found;
+        benchmark::DoNotOptimize(board->enemyIndex.nearest(points[next], found));
+        benchmark::DoNotOptimize(found);
+        next = (next + 1) % points.size();
+    }
+}
+BENCHMARK(BM_NearestIndex)->Apply(sizesAndEntities);
+
+/**
+ * @brief Nearest enemy by looking at every square (what the index replaces)
+ */
+static void BM_NearestScan(benchmark::State& state) {
+    int size = (int)state.range(0);
+    auto board = makePopulatedBoard(size, (int)state.range(1));
+    vector<Position> points = queryPoints(size);
+    size_t next = 0;
+    for (auto _ : state) {
+        Position from = points[next];
+        Position found = {-1, -1};
+        int best = -1;
+        for (int row = 0; row < size; row++) {
+            for (int column = 0; column < size; column++) {
+                if (!board->at(row, column).enemy) continue;
+                int distance = abs(row - from.row) + abs(column - from.column);
+                if (best < 0 || distance < best) {
+                    best = distance;
+                    found = {row, column};
+                }
+            }
+        }
+        benchmark::DoNotOptimize(found);
+        next = (next + 1) % points.size();
+    }
+}
+BENCHMARK(BM_NearestScan)->Apply(sizesAndEntities)->Unit(benchmark::kMicrosecond);
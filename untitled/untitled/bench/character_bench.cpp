@@ -0,0 +1,238 @@
+/**
+ * @file character_bench.cpp
+ * @brief Microbenchmarks of characters and combat
+ *
+ * attack() between every pair of races, against the quiet fastAttack()
+ * (combat.hpp) attack() is built on and one raceAttack() instantiation
+ * called directly; successfulDef() through the race jump table against
+ * calling the race's handler directly; Character::pickUp() of every
+ * catalogue item, the getTotal* stat getters with a growing number of
+ * rings equipped, and printing 100k character summaries and item lines
+ * through TextBuffer against the cout << chains they replaced.
+ *
+ * @author [Ish Soundankar]
+ */
+#include "bench.hpp"
+#include <game.hpp>
+#include <combat.hpp>
+
+/**
+ * @brief One attack; arguments are the attacker's and defender's race (1-5)
+ *
+ * The defender's health is restored every time so the fight never ends.
+ */
+static void BM_Attack(benchmark::State& state) {
+    auto attacker = makeCharacter((int)state.range(0), "Attacker");
+    auto defender = makeCharacter((int)state.range(1), "Defender");
+    int attackerHealth = attacker->health;
+    int defenderHealth = defender->health;
+    gameRandom().state = 1;
+    QuietOutput quiet;
+    for (auto _ : state) {
+        attack(attacker.get(), defender.get());
+        attacker->health = attackerHealth;
+        defender->health = defenderHealth;
+    }
+}
+BENCHMARK(BM_Attack)->ArgsProduct({benchmark::CreateDenseRange(1, 5, 1), benchmark::CreateDenseRange(1, 5, 1)});
+
+/**
+ * @brief attack() without its messages, as bulk simulation plays it
+ *
+ * Arguments as BM_Attack.
+ */
+static void BM_AttackFast(benchmark::State& state) {
+    auto attacker = makeCharacter((int)state.range(0), "Attacker");
+    auto defender = makeCharacter((int)state.range(1), "Defender");
+    int attackerHealth = attacker->health;
+    int defenderHealth = defender->health;
+    gameRandom().state = 1;
+    for (auto _ : state) {
+        fastAttack(*attacker, *defender);
+        attacker->health = attackerHealth;
+        defender->health = defenderHealth;
+    }
+}
+BENCHMARK(BM_AttackFast)->ArgsProduct({benchmark::CreateDenseRange(1, 5, 1), benchmark::CreateDenseRange(1, 5, 1)});
+
+/**
+ * @brief One quiet raceAttack() instantiation called directly (no table)
+ */
+template <typename AttackerRace, typename DefenderRace>
+static void BM_RaceAttack(benchmark::State& state) {
+    auto attacker = makeCharacter(AttackerRace::id + 1, "Attacker");
+    auto defender = makeCharacter(DefenderRace::id + 1, "Defender");
+    int defenderHealth = defender->health;
+    gameRandom().state = 1;
+    for (auto _ : state) {
+        raceAttack<AttackerRace, DefenderRace>(*attacker, *defender);
+        defender->health = defenderHealth;
+    }
+}
+BENCHMARK_TEMPLATE(BM_RaceAttack, ElfTraits, OrcDay);
+BENCHMARK_TEMPLATE(BM_RaceAttack, HumanTraits, DwarfTraits);
+
+/**
+ * @brief One successful defence through successfulDef() (argument: race 1-5)
+ *
+ * Dispatched through the raceDefences table on the defender's race id.
+ */
+static void BM_SuccessfulDefence(benchmark::State& state) {
+    auto attacker = makeCharacter(1, "Attacker");
+    auto defender = makeCharacter((int)state.range(0), "Defender");
+    Character* defending = defender.get();
+    int defenderHealth = defender->health;
+    gameRandom().state = 1;
+    QuietOutput quiet;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(defending);
+        defending->successfulDef(attacker.get(), defending);
+        defending->health = defenderHealth;
+    }
+}
+BENCHMARK(BM_SuccessfulDefence)->DenseRange(1, 5);
+
+/**
+ * @brief The same defence calling the race's handler directly (no dispatch)
+ */
+template <typename Race, typename Traits>
+static void BM_DefendDirect(benchmark::State& state) {
+    auto attacker = makeCharacter(1, "Attacker");
+    auto defender = makeCharacter(Traits::id + 1, "Defender");
+    Character* defending = defender.get();
+    int defenderHealth = defender->health;
+    gameRandom().state = 1;
+    QuietOutput quiet;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(defending);
+        Race::defend(attacker.get(), defending);
+        defending->health = defenderHealth;
+    }
+}
+BENCHMARK_TEMPLATE(BM_DefendDirect, Human, HumanTraits);
+BENCHMARK_TEMPLATE(BM_DefendDirect, Elf, ElfTraits);
+BENCHMARK_TEMPLATE(BM_DefendDirect, Dwarf, DwarfTraits);
+BENCHMARK_TEMPLATE(BM_DefendDirect, Hobbit, HobbitTraits);
+BENCHMARK_TEMPLATE(BM_DefendDirect, Orc, OrcDay);
+
+/**
+ * @brief Pick up one catalogue item (argument: its id), then take it off again
+ *
+ * Heavy items on a weak race measure the "too heavy" path.
+ */
+static void BM_PickUp(benchmark::State& state) {
+    auto player = makeCharacter(3, "Player");
+    const shared_ptr<Item>& item = ItemCatalogue[state.range(0)];
+    player->inventory.reserve(1);
+    player->ring.reserve(1);
+    QuietOutput quiet;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(player->pickUp(item));
+        player->weapon = nullptr;
+        player->armor = nullptr;
+        player->shield = nullptr;
+        player->ring.clear();
+        player->inventory.clear();
+    }
+    state.SetLabel(item->name);
+}
+BENCHMARK(BM_PickUp)->DenseRange(0, (int)ItemCatalogue.size() - 1);
+
+/**
+ * @brief All four getTotal* getters; argument is the number of rings worn
+ */
+static void BM_TotalStats(benchmark::State& state) {
+    auto player = makeCharacter(1, "Player");
+    player->weapon = Sword;
+    player->armor = LeatherArmor;
+    player->shield = SmallShield;
+    for (int i = 0; i < state.range(0); i++) {
+        player->ring.push_back(i % 2 ? RingOfStrength : RingOfLife);
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(player->getTotalAttack());
+        benchmark::DoNotOptimize(player->getTotalDefence());
+        benchmark::DoNotOptimize(player->getTotalStrength());
+        benchmark::DoNotOptimize(player->getTotalHealth());
+    }
+}
+BENCHMARK(BM_TotalStats)->Arg(0)->Arg(1)->Arg(4)->Arg(16);
+
+/// Characters (or items) printed per iteration of the printing benchmarks
+const int PRINTED = 100000;
+
+/**
+ * @brief The line printStats() printed before TextBuffer, chained on the stream
+ */
+static void printStatsStream(const Character& character) {
+    if (character.raceId == RACE_ORC) {
+        gameOut() << "Orc " << character.name << " stats: "
+             << "Attack: " << character.getTotalAttack() << "Defence: " << character.getTotalDefence()
+             << "Health: " << character.getTotalHealth() << ", Strength: " << character.getTotalStrength()
+             << (static_cast<const Orc&>(character).isNight ? " [Night]" : " [Day]") << endl;
+        return;
+    }
+    gameOut() << character.name << ", race: " << character.race << ", attack: " << character.getTotalAttack()
+              << ", defence: " << character.getTotalDefence() << ", health: " << character.getTotalHealth()
+              << ", strength: " << character.getTotalStrength() << endl;
+}
+
+/**
+ * @brief printStats() of 100k characters of every race (TextBuffer, one write each)
+ */
+static void BM_PrintSummaries(benchmark::State& state) {
+    auto characters = makeEnemies(PRINTED);
+    QuietOutput quiet;
+    for (auto _ : state) {
+        for (const auto& character : characters) character->printStats();
+    }
+    state.SetItemsProcessed(state.iterations() * PRINTED);
+}
+BENCHMARK(BM_PrintSummaries)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief The same 100k summaries chained on the stream with endl, as before TextBuffer
+ */
+static void BM_PrintSummariesStream(benchmark::State& state) {
+    auto characters = makeEnemies(PRINTED);
+    QuietOutput quiet;
+    for (auto _ : state) {
+        for (const auto& character : characters) printStatsStream(*character);
+    }
+    state.SetItemsProcessed(state.iterations() * PRINTED);
+}
+BENCHMARK(BM_PrintSummariesStream)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief 100k summaries formatted into one 64 KiB TextBuffer, written when it fills
+ *
+ * What a caller printing many lines at once (a board's printInfo()) could
+ * do instead of one TextLine per line.
+ */
+static void BM_PrintSummariesBatched(benchmark::State& state) {
+    auto characters = makeEnemies(PRINTED);
+    vector<char> memory(1 << 16);
+    QuietOutput quiet;
+    for (auto _ : state) {
+        TextBuffer out(memory.data(), memory.size(), gameOut());
+        for (const auto& character : characters) {
+            if (out.capacity - out.length < 256) out.flush();
+            character->formatStats(out);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * PRINTED);
+}
+BENCHMARK(BM_PrintSummariesBatched)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Item::print() of 100k catalogue items
+ */
+static void BM_PrintItems(benchmark::State& state) {
+    auto items = makeItems(PRINTED);
+    QuietOutput quiet;
+    for (auto _ : state) {
+        for (const auto& item : items) item->print();
+    }
+    state.SetItemsProcessed(state.iterations() * PRINTED);
+}
+BENCHMARK(BM_PrintItems)->Unit(benchmark::kMillisecond);
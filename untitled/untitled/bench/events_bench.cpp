@@ -0,0 +1,59 @@
+/**
+ * @file events_bench.cpp
+ * @brief Microbenchmarks of the gameplay event log
+ *
+ * Recording events into the ring and writing them out as JSON Lines or
+ * binary records to a stream that discards them, and the cost of attack()
+ * with the log enabled against disabled.
+ *
+ * @author [Ish Soundankar]
+ */
+#include "bench.hpp"
+#include <events.hpp>
+#include <combat.hpp>
+
+/**
+ * @brief Record and write events; argument 0 = JSON Lines, 1 = binary
+ *
+ * A mix of the event types a turn of combat records, with real names.
+ */
+static void BM_EventLog(benchmark::State& state) {
+    NullSink sink;
+    ostream discard(&sink);
+    EventLog log;
+    log.open(discard, state.range(0) ? EVENTS_BINARY : EVENTS_JSONL);
+    InternedString player("Player"), enemy("Legolas"), race("Elf"), item("Sword");
+    int turn = 0;
+    for (auto _ : state) {
+        log.beginTurn(++turn, {turn & 63, turn >> 6 & 63});
+        log.record(EVENT_MOVE, player);
+        log.record(EVENT_ENCOUNTER, enemy, race);
+        log.record(EVENT_ATTACK, player, enemy, ATTACK_HIT);
+        log.record(EVENT_DAMAGE, enemy, InternedString(), 20, turn & 127);
+        log.record(EVENT_PICKUP, item, InternedString(), 1);
+    }
+    log.close();
+    state.SetItemsProcessed(state.iterations() * 5);
+    state.SetLabel(state.range(0) ? "binary" : "jsonl");
+}
+BENCHMARK(BM_EventLog)->Arg(0)->Arg(1);
+
+/**
+ * @brief fastAttack(); arguments are 1 = event log enabled, and the race of both (1-5)
+ */
+static void BM_AttackEvents(benchmark::State& state) {
+    NullSink sink;
+    ostream discard(&sink);
+    if (state.range(0)) gameEvents().open(discard, EVENTS_BINARY);
+    auto attacker = makeCharacter((int)state.range(1), "Attacker");
+    auto defender = makeCharacter((int)state.range(1), "Defender");
+    int defenderHealth = defender->health;
+    gameRandom().state = 1;
+    QuietOutput quiet;
+    for (auto _ : state) {
+        fastAttack(*attacker, *defender);
+        defender->health = defenderHealth;
+    }
+    gameEvents().close();
+}
+BENCHMARK(BM_AttackEvents)->ArgsProduct({{0, 1}, {3, 5}});
@@ -3,62 +3,862 @@
  * @brief Implementation of Board class methods
  *
  * This file contains the implementation of the populateBoard() method
- * which randomly places enemies and items on the game board.
+ * which places enemies and items on the game board following its spawn
+ * rules (spawn.hpp), the chunk generator for endless boards, the
+ * multi-threaded generator of whole bounded boards, the A* route finder
+ * used by auto-travel commands, the field-of-view scan used for fog of
+ * war, and chunk paging.
  *
  * @author [Ish Soundankar]
  */
 #include "board.hpp"
-#include <cstdlib> // rand, srand
-#include <ctime>
+#include <cstdlib> // abs
+#include <algorithm> // push_heap, pop_heap, reverse
+#include <thread>
+#include "ItemsDB.h"
+#include "serialize.hpp"
+#include "random.hpp"
+#include "terrain.hpp"
+
+// Mixed into the seed so spawn points are not drawn from the chunks' or the caves' streams
+const uint64_t SPAWN_STREAM = 0x535041574E;  // "SPAWN"
 
 /**
- * @brief Randomly place enemies and items on the game board
+ * @brief Take a random position out of a list
+ */
+static Position takeRandom(vector<Position>& positions, GameRandom& random) {
+    size_t pick = random.nextInt((int)positions.size());
+    Position taken = positions[pick];
+    positions[pick] = positions.back();
+    positions.pop_back();
+    return taken;
+}
+
+/**
+ * @brief Place enemies and items on the game board, following spawnRules
  *
  * Pseudo-code:
- * 1. Seed random number generator with current time
- * 2. FOR each enemy in enemies vector:
- *    a. Generate random x, y coordinates
- *    b. WHILE square at (x,y) already has an enemy:
- *       - Generate new random x, y coordinates
- *    c. Place enemy at (x,y)
- * 3. FOR each item in items vector:
- *    a. Generate random x, y coordinates
- *    b. WHILE square at (x,y) has enemy OR item:
- *       - Generate new random x, y coordinates
- *    c. Place item at (x,y)
+ * 1. Block the squares fewer than startClearance steps from the start
+ *    square (SpawnSampler::keepClear())
+ * 2. Lay points over the rest (SpawnSampler::sample()), enemySpacing apart
+ *    or, on a board with room for many more, as far apart as leaves a few
+ *    per enemy (SpawnSampler::spreadSpacing())
+ * 3. FOR each enemy in enemies vector:
+ *    a. Take a random point; IF none are left (the board is too small for
+ *       the rules): a random square with no enemy, other than the start
+ *    b. Place enemy there and add it to the enemy index
+ * 4. Unblock everything but the enemies' squares and lay points itemSpacing
+ *    apart (or further, as for the enemies)
+ * 5. Allow each region (regionSize squares across) an equal share of the items
+ * 6. FOR each item in items vector:
+ *    a. Take random points until one is in a region with room left;
+ *       IF none are left: a random square with no enemy or item
+ *    b. Place item there and add it to the item index
  *
  * @param enemies Vector of enemy characters to place on board
  * @param items Vector of items to place on board
  */
-void Board::populateBoard(const vector<shared_ptr<Character>> enemies,
-                          const vector<shared_ptr<Item>> items) {
-    srand(time(nullptr));
+void Board::populateBoard(const vector<shared_ptr<Character>>& enemies,
+                          const vector<shared_ptr<Item>>& items) {
+    GameRandom& random = gameRandom();
+    SpawnSampler sampler(width, height);
+    vector<Position> points;
+    vector<Position> placed;
 
-    // Place each enemy on a random empty square
+    // Place each enemy on a point clear of the start and of the other enemies
+    sampler.keepClear({{0, 0}}, spawnRules.startClearance);
+    sampler.sample(SpawnSampler::spreadSpacing(spawnRules.enemySpacing, (long long)width * height, enemies.size()),
+                   random, points);
     for (size_t i = 0; i < enemies.size(); i++) {
-        shared_ptr<Character> enemyPointer = enemies[i];
-        int x = rand() % height;
-        int y = rand() % width;
+        Position p = {0, 0};
+        if (!points.empty()) {
+            p = takeRandom(points, random);
+        } else {
+            do {
+                p = {random.nextInt(height), random.nextInt(width)};
+            } while (at(p.row, p.column).enemy != nullptr || (p.row == 0 && p.column == 0));
+        }
+        placeEnemy(p.row, p.column, enemies[i]);
+        placed.push_back(p);
+    }
 
-        while (grid[x][y]->enemy != nullptr) {
-            x = rand() % height;
-            y = rand() % width;
+    // Place each item on a point away from the other items, spread over the regions
+    sampler.clear();
+    for (const Position& p : placed) sampler.block(p.row, p.column);
+    sampler.sample(SpawnSampler::spreadSpacing(spawnRules.itemSpacing, (long long)width * height, items.size()),
+                   random, points);
+    int regionSize = max(1, spawnRules.regionSize);
+    int regionColumns = (width + regionSize - 1) / regionSize;
+    size_t regions = (size_t)((height + regionSize - 1) / regionSize) * regionColumns;
+    size_t perRegion = (items.size() + regions - 1) / regions;
+    vector<size_t> inRegion(regions, 0);
+    for (size_t i = 0; i < items.size(); i++) {
+        bool found = false;
+        Position p = {0, 0};
+        while (!found && !points.empty()) {
+            p = takeRandom(points, random);
+            size_t& count = inRegion[(size_t)(p.row / regionSize) * regionColumns + p.column / regionSize];
+            if (count < perRegion) {
+                count++;
+                found = true;
+            }
+        }
+        while (!found) {
+            p = {random.nextInt(height), random.nextInt(width)};
+            found = at(p.row, p.column).enemy == nullptr && at(p.row, p.column).item == nullptr;
         }
+        placeItem(p.row, p.column, items[i]);
+    }
+}
+
+// Names generated enemies are given
+static const char* const enemyNames[] = {"Bob", "Legolas", "Gimli", "Frodo", "Azog",
+                                         "Boromir", "Tauriel", "Thorin", "Sam", "Bolg"};
+static const int ENEMY_NAMES = 10;
 
-        grid[x][y]->enemy = enemyPointer;
+/**
+ * @brief Create a generated enemy
+ *
+ * @param race 0 = Human, 1 = Elf, 2 = Dwarf, 3 = Hobbit, 4 = Orc
+ * @param name Enemy's name
+ * @param night Time of day (for Orcs)
+ * @return New enemy
+ */
+static shared_ptr<Character> makeEnemy(int race, const char* name, bool night) {
+    switch (race) {
+    case 0: return make_shared<Human>(name);
+    case 1: return make_shared<Elf>(name);
+    case 2: return make_shared<Dwarf>(name);
+    case 3: return make_shared<Hobbit>(name);
+    default: {
+        auto orc = make_shared<Orc>(name);
+        orc->setTimeOfDay(night);
+        return orc;
     }
+    }
+}
 
-    // Place each item on a random empty square (no enemy or item already there)
-    for (size_t i = 0; i < items.size(); i++) {
-        shared_ptr<Item> itemPointer = items[i];
-        int x = rand() % height;
-        int y = rand() % width;
+/**
+ * @brief Random stream of one chunk
+ *
+ * Derived from the seed and chunk coordinates only, never from the order
+ * chunks are visited in (or the thread that fills them).
+ */
+static GameRandom chunkStream(unsigned worldSeed, int chunkRow, int chunkColumn) {
+    GameRandom random(worldSeed);
+    random.state = random.next() ^ (uint64_t)(unsigned)chunkRow;
+    random.state = random.next() ^ ((uint64_t)(unsigned)chunkColumn << 32);
+    return random;
+}
+
+/**
+ * @brief Fill a freshly allocated chunk of an endless board
+ *
+ * Pseudo-code:
+ * 1. Place the chunk's enemies and items (fillChunk())
+ * 2. Add their positions to the enemy and item indexes
+ *
+ * @param chunkRow Chunk row (row / Chunk::SIZE)
+ * @param chunkColumn Chunk column (column / Chunk::SIZE)
+ * @param chunk Chunk to fill
+ */
+void Board::generateChunk(int chunkRow, int chunkColumn, Chunk& chunk) {
+    newEnemies.clear();
+    newItems.clear();
+    fillChunk(chunkRow, chunkColumn, chunk, newEnemies, newItems);
+    for (const Position& p : newEnemies) enemyIndex.insert(p);
+    for (const Position& p : newItems) itemIndex.insert(p);
+}
+
+/**
+ * @brief Place a chunk's enemies and items, derived from the seed and its coordinates
+ *
+ * Pseudo-code:
+ * 1. Derive the chunk's random state from (seed, chunkRow, chunkColumn)
+ * 2. Count the chunk's squares that are on the board
+ * 3. FOR ENEMIES_PER_CHUNK enemies (fewer if the chunk has too few squares):
+ *    a. Pick a random free square of those (never the start square 0,0)
+ *    b. Create an enemy of a random race, matching the board's time of day
+ *    c. Place it and append its position to enemies
+ * 4. FOR ITEMS_PER_CHUNK items (fewer if the chunk has too few squares):
+ *    a. Pick a random square without an enemy or item
+ *    b. Place a random item from the items database, append its position to items
+ *
+ * @param chunkRow Chunk row (row / Chunk::SIZE)
+ * @param chunkColumn Chunk column (column / Chunk::SIZE)
+ * @param chunk Chunk to fill (empty)
+ * @param enemies Board positions of the enemies placed are appended here
+ * @param items Board positions of the items placed are appended here
+ */
+void Board::fillChunk(int chunkRow, int chunkColumn, Chunk& chunk,
+                      vector<Position>& enemies, vector<Position>& items) const {
+    GameRandom random = chunkStream(seed, chunkRow, chunkColumn);
+    int firstRow = chunkRow * Chunk::SIZE;
+    int firstColumn = chunkColumn * Chunk::SIZE;
+    int rows = min(Chunk::SIZE, height - firstRow);
+    int columns = min(Chunk::SIZE, width - firstColumn);
+    int squares = rows * columns;
+    bool hasStart = firstRow == 0 && firstColumn == 0;
+
+    // Square number n of those on the board, as an index into chunk.squares
+    auto localSquare = [&](int n) { return n / columns * Chunk::SIZE + n % columns; };
+
+    int enemyCount = min(ENEMIES_PER_CHUNK, squares - (hasStart ? 1 : 0));
+    for (int i = 0; i < enemyCount; i++) {
+        int local = localSquare(random.nextInt(squares));
+        while (chunk.squares[local].enemy || (hasStart && local == 0)) {
+            local = localSquare(random.nextInt(squares));
+        }
+
+        const char* name = enemyNames[random.nextInt(ENEMY_NAMES)];
+        chunk.squares[local].enemy = makeEnemy(random.nextInt(5), name, night);
+        enemies.push_back({firstRow + local / Chunk::SIZE, firstColumn + local % Chunk::SIZE});
+    }
 
-        while (grid[x][y]->enemy != nullptr || grid[x][y]->item != nullptr) {
-            x = rand() % height;
-            y = rand() % width;
+    int itemCount = min(ITEMS_PER_CHUNK, squares - enemyCount);
+    for (int i = 0; i < itemCount; i++) {
+        int local = localSquare(random.nextInt(squares));
+        while (chunk.squares[local].enemy || chunk.squares[local].item) {
+            local = localSquare(random.nextInt(squares));
         }
+        chunk.squares[local].item = ItemCatalogue[random.nextInt((int)ItemCatalogue.size())];
+        items.push_back({firstRow + local / Chunk::SIZE, firstColumn + local % Chunk::SIZE});
+    }
+}
 
-        grid[x][y]->item = itemPointer;
+/**
+ * @brief Create the enemies and items planned for a chunk of a generated board
+ *
+ * Pseudo-code:
+ * 1. Derive the chunk's random state from (seed, chunkRow, chunkColumn)
+ * 2. FOR each planned enemy: create an enemy with a random name and race,
+ *    matching the board's time of day, on its square
+ * 3. FOR each planned item: put a random item from the items database on its square
+ *
+ * @param chunkRow Chunk row (row / Chunk::SIZE)
+ * @param chunkColumn Chunk column (column / Chunk::SIZE)
+ * @param chunk Chunk to fill (empty apart from its walls)
+ * @param enemies Board positions of the chunk's enemies
+ * @param enemyCount Number of enemies
+ * @param items Board positions of the chunk's items
+ * @param itemCount Number of items
+ */
+void Board::stockChunk(int chunkRow, int chunkColumn, Chunk& chunk, const Position* enemies,
+                       size_t enemyCount, const Position* items, size_t itemCount) const {
+    GameRandom random = chunkStream(seed, chunkRow, chunkColumn);
+    for (size_t i = 0; i < enemyCount; i++) {
+        int local = enemies[i].row % Chunk::SIZE * Chunk::SIZE + enemies[i].column % Chunk::SIZE;
+        const char* name = enemyNames[random.nextInt(ENEMY_NAMES)];
+        chunk.squares[local].enemy = makeEnemy(random.nextInt(5), name, night);
+    }
+    for (size_t i = 0; i < itemCount; i++) {
+        int local = items[i].row % Chunk::SIZE * Chunk::SIZE + items[i].column % Chunk::SIZE;
+        chunk.squares[local].item = ItemCatalogue[random.nextInt((int)ItemCatalogue.size())];
+    }
+}
+
+/**
+ * @brief Keep up to perChunk of the points in each chunk of a chunk row, picked at random
+ *
+ * Pseudo-code:
+ * 1. Count the points in each chunk and sort them by chunk (counting sort)
+ * 2. FOR each chunk in order: move up to perChunk of its points, picked at
+ *    random, to kept, noting where each chunk's points start
+ *
+ * @param points Points to pick from (all in one chunk row)
+ * @param chunkColumns Chunks in the row
+ * @param perChunk Most points kept in a chunk
+ * @param random Stream the picks are drawn from
+ * @param kept Set to the points kept, chunk by chunk
+ * @param starts Set to the index in kept of each chunk's first point (one more entry than chunks)
+ */
+static void pickPerChunk(const vector<Position>& points, int chunkColumns, int perChunk,
+                         GameRandom& random, vector<Position>& kept, vector<size_t>& starts) {
+    size_t chunkCount = (size_t)chunkColumns;
+    auto chunkOf = [&](Position p) { return (size_t)(p.column / Chunk::SIZE); };
+    vector<size_t> first(chunkCount + 1, 0);
+    for (const Position& p : points) first[chunkOf(p) + 1]++;
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) first[chunk + 1] += first[chunk];
+    vector<Position> sorted(points.size());
+    vector<size_t> next(first.begin(), first.end() - 1);
+    for (const Position& p : points) sorted[next[chunkOf(p)]++] = p;
+
+    kept.clear();
+    starts.assign(chunkCount + 1, 0);
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        starts[chunk] = kept.size();
+        size_t begin = first[chunk];
+        size_t left = first[chunk + 1] - begin;
+        for (int i = 0; i < perChunk && left > 0; i++, left--) {
+            size_t pick = begin + random.nextInt((int)left);
+            kept.push_back(sorted[pick]);
+            sorted[pick] = sorted[begin + left - 1];
+        }
+    }
+    starts[chunkCount] = kept.size();
+}
+
+/**
+ * @struct SpawnRow
+ * @brief Enemies and items planned for one chunk row of a generated board
+ */
+struct SpawnRow {
+    vector<Position> enemies;     ///< Enemies' squares, chunk by chunk
+    vector<size_t> enemyStarts;   ///< Index in enemies of each chunk's first (one more entry than chunks)
+    vector<Position> items;       ///< Items' squares, chunk by chunk
+    vector<size_t> itemStarts;    ///< Index in items of each chunk's first (one more entry than chunks)
+};
+
+/**
+ * @struct GeneratedBand
+ * @brief Chunk rows one thread of Board::generate() works on, and the chunks it created
+ */
+struct GeneratedBand {
+    int firstChunkRow = 0;              ///< First chunk row of the band
+    int lastChunkRow = 0;               ///< One past the band's last chunk row
+    vector<unique_ptr<Chunk>> chunks;   ///< The band's chunks, row by row
+};
+
+/**
+ * @brief Plan the enemies or items of one chunk row of a generated board
+ *
+ * Pseudo-code:
+ * 1. Derive the row's random state from (seed, chunk row, what is planned)
+ * 2. Copy the row's walls from the cave map into a sampler of just its rows
+ * 3. Block the squares near the start square (first chunk row only), the
+ *    squares in taken, and those closer than spacing to the points planned
+ *    in the chunk rows above and below (neighbours)
+ * 4. Lay points spacing apart over the rest (SpawnSampler::sample())
+ * 5. Keep up to perChunk of them in each chunk (pickPerChunk())
+ *
+ * @param caves The board's cave map
+ * @param worldSeed Seed of the board
+ * @param chunkRow Chunk row to plan
+ * @param stream Which plan this is (0: enemies, 1: items), so each has its own random stream
+ * @param spacing Least distance between two points (at most Chunk::SIZE)
+ * @param clearance Steps from the start square no point may be within (0: none)
+ * @param perChunk Most points kept in a chunk
+ * @param taken Squares no point may be put on
+ * @param neighbours Points already planned in the chunk rows above and below
+ * @param kept Set to the points kept, chunk by chunk
+ * @param starts Set to the index in kept of each chunk's first point
+ */
+static void planSpawnRow(const CaveMap& caves, unsigned worldSeed, int chunkRow, int stream, int spacing, int clearance,
+                         int perChunk, const vector<Position>& taken, const vector<const vector<Position>*>& neighbours,
+                         vector<Position>& kept, vector<size_t>& starts) {
+    GameRandom random(worldSeed);
+    random.state = random.next() ^ SPAWN_STREAM;
+    random.state = random.next() ^ (uint64_t)(unsigned)chunkRow;
+    random.state = random.next() ^ (uint64_t)stream;
+    int firstRow = chunkRow * Chunk::SIZE;
+    int rows = min(Chunk::SIZE, caves.height - firstRow);
+    int chunkColumns = caves.words;  // A word of a cave map row per chunk column
+
+    SpawnSampler sampler(caves.width, rows);
+    sampler.blocked.assign(caves.walls.begin() + (size_t)firstRow * caves.words,
+                           caves.walls.begin() + (size_t)(firstRow + rows) * caves.words);
+    if (chunkRow == 0) sampler.keepClear({{0, 0}}, clearance);
+    for (const Position& p : taken) sampler.block(p.row - firstRow, p.column);
+    for (const vector<Position>* points : neighbours) {
+        for (const Position& p : *points) sampler.keepAway(p.row - firstRow, p.column, spacing);
+    }
+
+    vector<Position> points;
+    sampler.sample(spacing, random, points);
+    pickPerChunk(points, chunkColumns, perChunk, random, kept, starts);
+    for (Position& p : kept) p.row += firstRow;
+}
+
+/**
+ * @brief Allocate and fill every chunk of a bounded board from a world seed
+ *
+ * Enemies and items are planned chunk row by chunk row, each row with
+ * its own random stream, so rows can be planned on any thread. The
+ * spacing is at most a chunk, so only rows next to each other can hold
+ * points too close together: the even rows are planned first, then the
+ * odd rows keep away from them.
+ *
+ * Pseudo-code:
+ * 1. Grow the board's caves (CaveMap) from the seed, open at the start square
+ * 2. Split the chunk rows into one band per thread (no more bands than rows)
+ * 3. Intern the names and races enemies can get, so the threads only ever
+ *    look strings up in the table and never add to it
+ * 4. In three passes, each on every band's thread at once (joined before
+ *    the next), planSpawnRow() the rows of each band:
+ *    a. Even rows: enemies, GENERATED_SPACING apart (at least enemySpacing),
+ *       clear of the start, up to ENEMIES_PER_CHUNK per chunk
+ *    b. Odd rows: enemies, keeping away from the rows next to them.
+ *       Even rows: items, on squares without an enemy, up to
+ *       ITEMS_PER_CHUNK per chunk
+ *    c. Odd rows: items, keeping away from the rows next to them. Then,
+ *       FOR each chunk of the band: create it, copy its walls from the cave
+ *       map and stockChunk() it with its planned enemies and items
+ * 5. Add the bands' chunks to the board in order, and the planned enemies
+ *    and items to the indexes
+ *
+ * @param worldSeed Seed every chunk's content is derived from
+ * @param threads Threads to use (0: one per hardware thread)
+ */
+void Board::generate(unsigned worldSeed, int threads) {
+    seed = worldSeed;
+    int chunkRows = (height + Chunk::SIZE - 1) / Chunk::SIZE;
+    int chunkColumns = (width + Chunk::SIZE - 1) / Chunk::SIZE;
+    if (threads <= 0) threads = max(1, (int)thread::hardware_concurrency());
+    threads = max(1, min(threads, chunkRows));
+
+    CaveMap caves(width, height);
+    caves.generate(worldSeed, {0, 0});
+    walled = true;
+
+    vector<GeneratedBand> bands(threads);
+    for (int b = 0; b < threads; b++) {
+        bands[b].firstChunkRow = (int)((long long)chunkRows * b / threads);
+        bands[b].lastChunkRow = (int)((long long)chunkRows * (b + 1) / threads);
+    }
+
+    // Intern every name a band thread may give an enemy before they start (the string table is not locked)
+    for (const char* name : enemyNames) stringTable().intern(name);
+    for (const char* race : {HumanTraits::stats.name, ElfTraits::stats.name, DwarfTraits::stats.name,
+                             HobbitTraits::stats.name, OrcDay::stats.name}) {
+        stringTable().intern(race);
+    }
+
+    // Run work(band) for every band, each on its own thread (the first on this one)
+    auto inBands = [&](auto work) {
+        vector<thread> workers;
+        for (int b = 1; b < threads; b++) workers.emplace_back(work, ref(bands[b]));
+        work(bands[0]);
+        for (thread& worker : workers) worker.join();
+    };
+
+    int enemySpacing = min(max(spawnRules.enemySpacing, GENERATED_SPACING), (int)Chunk::SIZE);
+    int itemSpacing = min(max(spawnRules.itemSpacing, GENERATED_SPACING), (int)Chunk::SIZE);
+    int clearance = min(spawnRules.startClearance, (int)Chunk::SIZE);
+    vector<SpawnRow> spawns(chunkRows);
+    const vector<Position> none;
+    // Points planned in the chunk rows next to a row (enemies or items)
+    auto besideRow = [&](int chunkRow, vector<Position> SpawnRow::*planned) {
+        vector<const vector<Position>*> beside;
+        if (chunkRow > 0) beside.push_back(&(spawns[chunkRow - 1].*planned));
+        if (chunkRow < chunkRows - 1) beside.push_back(&(spawns[chunkRow + 1].*planned));
+        return beside;
+    };
+    auto planEnemies = [&](int chunkRow) {
+        SpawnRow& row = spawns[chunkRow];
+        planSpawnRow(caves, worldSeed, chunkRow, 0, enemySpacing, clearance, ENEMIES_PER_CHUNK, none,
+                     besideRow(chunkRow, &SpawnRow::enemies), row.enemies, row.enemyStarts);
+    };
+    auto planItems = [&](int chunkRow) {
+        SpawnRow& row = spawns[chunkRow];
+        planSpawnRow(caves, worldSeed, chunkRow, 1, itemSpacing, 0, ITEMS_PER_CHUNK, row.enemies,
+                     besideRow(chunkRow, &SpawnRow::items), row.items, row.itemStarts);
+    };
+
+    inBands([&](GeneratedBand& band) {
+        for (int chunkRow = band.firstChunkRow; chunkRow < band.lastChunkRow; chunkRow++) {
+            if (chunkRow % 2 == 0) planEnemies(chunkRow);
+        }
+    });
+    inBands([&](GeneratedBand& band) {
+        for (int chunkRow = band.firstChunkRow; chunkRow < band.lastChunkRow; chunkRow++) {
+            if (chunkRow % 2 == 1) planEnemies(chunkRow);
+            else planItems(chunkRow);
+        }
+    });
+    inBands([&](GeneratedBand& band) {
+        band.chunks.reserve((size_t)(band.lastChunkRow - band.firstChunkRow) * chunkColumns);
+        for (int chunkRow = band.firstChunkRow; chunkRow < band.lastChunkRow; chunkRow++) {
+            if (chunkRow % 2 == 1) planItems(chunkRow);
+            const SpawnRow& planned = spawns[chunkRow];
+            for (int chunkColumn = 0; chunkColumn < chunkColumns; chunkColumn++) {
+                band.chunks.push_back(make_unique<Chunk>());
+                Chunk& chunk = *band.chunks.back();
+                // A chunk row is one word of a cave map row (minus the bits past the board)
+                uint64_t onBoard = chunkColumn == chunkColumns - 1 ? ~caves.paddingMask() : ~(uint64_t)0;
+                for (int row = 0; row < Chunk::SIZE && chunkRow * Chunk::SIZE + row < height; row++) {
+                    chunk.walls[row] = caves.walls[(size_t)(chunkRow * Chunk::SIZE + row) * caves.words + chunkColumn] & onBoard;
+                }
+                size_t e = planned.enemyStarts[chunkColumn];
+                size_t i = planned.itemStarts[chunkColumn];
+                stockChunk(chunkRow, chunkColumn, chunk, planned.enemies.data() + e, planned.enemyStarts[chunkColumn + 1] - e,
+                           planned.items.data() + i, planned.itemStarts[chunkColumn + 1] - i);
+            }
+        }
+    });
+
+    chunks.reserve(chunks.size() + (size_t)chunkRows * chunkColumns);
+    for (GeneratedBand& band : bands) {
+        size_t next = 0;
+        for (int chunkRow = band.firstChunkRow; chunkRow < band.lastChunkRow; chunkRow++) {
+            for (int chunkColumn = 0; chunkColumn < chunkColumns; chunkColumn++) {
+                chunks[chunkKey(chunkRow * Chunk::SIZE, chunkColumn * Chunk::SIZE)] = move(band.chunks[next++]);
+                residentBytes += sizeof(Chunk);
+            }
+        }
+    }
+    for (const SpawnRow& row : spawns) {
+        for (const Position& p : row.enemies) enemyIndex.insert(p);
+        for (const Position& p : row.items) itemIndex.insert(p);
+    }
+    lastChunkKey = -1;
+    lastChunk = nullptr;
+}
+
+/**
+ * @brief Switch every Orc on the board between day and night stats
+ *
+ * Pseudo-code:
+ * 1. Remember the time of day (for Orcs generated or paged in later)
+ * 2. FOR each position in the enemy index:
+ *    - IF its chunk is resident AND the enemy there is an Orc:
+ *      update its stats for the time of day
+ *
+ * @param isNight true if it's night, false if it's day
+ */
+void Board::setTimeOfDay(bool isNight) {
+    night = isNight;
+    enemyIndex.forEach([&](Position p) {
+        // Straight into the chunk: at() would mark it as just used, and
+        // trimMemory() would keep chunks with enemies over those near the player
+        const Chunk* chunk = findChunk(p.row, p.column);
+        if (!chunk) return;
+        const Square& square = chunk->squares[(p.row % Chunk::SIZE) * Chunk::SIZE + p.column % Chunk::SIZE];
+        Orc* orcPtr = dynamic_cast<Orc*>(square.enemy.get());
+        if (orcPtr) {
+            orcPtr->setTimeOfDay(isNight);
+        }
+    });
+}
+
+/**
+ * @brief Ordering for the A* open list (smallest estimate on top)
+ *
+ * Ties are broken towards the node with the larger cost so far, which is
+ * the one closer to the destination.
+ */
+static bool laterNode(const Board::PathNode& a, const Board::PathNode& b) {
+    if (a.estimate != b.estimate) return a.estimate > b.estimate;
+    return a.cost < b.cost;
+}
+
+/**
+ * @brief Find the shortest walking route between two squares (A*)
+ *
+ * Pseudo-code:
+ * 1. IF either end is off the board: RETURN false
+ * 2. Bump the query stamp (a square's scratch is stale unless its stamp matches)
+ * 3. Push start onto the open heap with cost 0
+ * 4. WHILE open heap not empty AND search limit not reached:
+ *    a. Pop the node with the smallest estimate
+ *    b. IF its cost is worse than the best known for that square: skip it
+ *    c. IF it is the destination: follow parent directions back into path, RETURN true
+ *    d. FOR each of the 4 neighbours inside the board that are not walls:
+ *       - IF neighbour not seen this query OR new cost is lower:
+ *         record cost and direction, push with estimate = cost + Manhattan distance
+ * 5. RETURN false (destination unreachable or too far)
+ *
+ * @param from Starting square
+ * @param to Destination square
+ * @param path Output route (excluding from, including to)
+ * @return true if a route was found
+ */
+bool Board::findPath(Position from, Position to, vector<Position>& path) {
+    static const int dRow[4] = {-1, 1, 0, 0};
+    static const int dColumn[4] = {0, 0, -1, 1};
+
+    path.clear();
+    if (!inBounds(from.row, from.column) || !inBounds(to.row, to.column)) {
+        return false;
+    }
+
+    // On wrap-around old stamps could collide with new queries, so reset them
+    if (++pathQuery == 0) {
+        for (auto& entry : chunks) {
+            if (entry.second->path) {
+                fill(begin(entry.second->path->stamp), end(entry.second->path->stamp), 0u);
+            }
+        }
+        pathQuery = 1;
+    }
+
+    pathOpen.clear();
+    Chunk::PathScratch& startScratch = pathScratchAt(from.row, from.column);
+    int startLocal = (from.row % Chunk::SIZE) * Chunk::SIZE + from.column % Chunk::SIZE;
+    startScratch.stamp[startLocal] = pathQuery;
+    startScratch.cost[startLocal] = 0;
+    pathOpen.push_back({abs(from.row - to.row) + abs(from.column - to.column), 0, from.row, from.column});
+
+    int expanded = 0;
+    while (!pathOpen.empty() && expanded < pathSearchLimit) {
+        pop_heap(pathOpen.begin(), pathOpen.end(), laterNode);
+        PathNode node = pathOpen.back();
+        pathOpen.pop_back();
+
+        // Stale entry: a cheaper route to this square was pushed later
+        int local = (node.row % Chunk::SIZE) * Chunk::SIZE + node.column % Chunk::SIZE;
+        if (node.cost > pathScratchAt(node.row, node.column).cost[local]) continue;
+        expanded++;
+
+        if (node.row == to.row && node.column == to.column) {
+            Position p = to;
+            while (p.row != from.row || p.column != from.column) {
+                path.push_back(p);
+                int k = pathScratchAt(p.row, p.column)
+                            .parent[(p.row % Chunk::SIZE) * Chunk::SIZE + p.column % Chunk::SIZE];
+                p.row -= dRow[k];
+                p.column -= dColumn[k];
+            }
+            reverse(path.begin(), path.end());
+            return true;
+        }
+
+        for (int k = 0; k < 4; k++) {
+            int nextRow = node.row + dRow[k];
+            int nextColumn = node.column + dColumn[k];
+            if (!inBounds(nextRow, nextColumn) || isWall(nextRow, nextColumn)) continue;
+
+            Chunk::PathScratch& scratch = pathScratchAt(nextRow, nextColumn);
+            int next = (nextRow % Chunk::SIZE) * Chunk::SIZE + nextColumn % Chunk::SIZE;
+            int cost = node.cost + 1;
+            if (scratch.stamp[next] == pathQuery && scratch.cost[next] <= cost) continue;
+
+            scratch.stamp[next] = pathQuery;
+            scratch.cost[next] = cost;
+            scratch.parent[next] = (unsigned char)k;
+            int estimate = cost + abs(nextRow - to.row) + abs(nextColumn - to.column);
+            pathOpen.push_back({estimate, cost, nextRow, nextColumn});
+            push_heap(pathOpen.begin(), pathOpen.end(), laterNode);
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Recompute which squares are in view from a position
+ *
+ * Pseudo-code:
+ * 1. FOR each square lit by the previous update: clear its visible bit
+ * 2. Mark the eye square visible
+ * 3. FOR each of the 8 octants around the eye:
+ *    - Cast light outwards from distance 1 over the full slope range [1, 0]
+ *
+ * @param eye Position the player is looking from
+ */
+void Board::updateFieldOfView(Position eye) {
+    static const int octants[4][8] = {
+        {1, 0, 0, -1, -1, 0, 0, 1},
+        {0, 1, -1, 0, 0, -1, 1, 0},
+        {0, 1, 1, 0, 0, -1, -1, 0},
+        {1, 0, 0, 1, -1, 0, 0, -1},
+    };
+
+    for (const Position& p : visibleSquares) {
+        chunkAt(p.row, p.column).visible[p.row % Chunk::SIZE] &= ~((uint64_t)1 << (p.column % Chunk::SIZE));
+    }
+    visibleSquares.clear();
+    if (!inBounds(eye.row, eye.column)) return;
+
+    markVisible(eye.row, eye.column);
+    for (int oct = 0; oct < 8; oct++) {
+        castLight(eye, 1, 1.0f, 0.0f,
+                  octants[0][oct], octants[1][oct], octants[2][oct], octants[3][oct]);
+    }
+}
+
+/**
+ * @brief Scan one octant for updateFieldOfView() (recursive shadowcasting)
+ *
+ * Pseudo-code:
+ * 1. IF startSlope < endSlope: RETURN (arc is empty)
+ * 2. FOR each row of the octant from distance to sightRadius:
+ *    a. FOR each square in the row, moving from the start slope to the end slope:
+ *       - Skip squares before the arc, stop after the arc
+ *       - IF inside the sight circle and on the board: mark visible
+ *       - IF previous square blocked sight:
+ *           IF this one blocks too: move the next start slope past it
+ *           ELSE: the shadow ends, continue the arc from the saved start slope
+ *       - ELSE IF this square blocks sight:
+ *           recurse for the part of the arc before it, then start a shadow
+ *    b. IF the row ended inside a shadow: RETURN
+ *
+ * @param eye Position being looked from
+ * @param distance First row of the octant to scan
+ * @param startSlope Slope where the visible arc starts
+ * @param endSlope Slope where the visible arc ends
+ * @param xx,xy,yx,yy Transform from octant coordinates to board offsets
+ */
+void Board::castLight(Position eye, int distance, float startSlope, float endSlope,
+                      int xx, int xy, int yx, int yy) {
+    if (startSlope < endSlope) return;
+
+    const int radiusSquared = sightRadius * sightRadius;
+    float nextStart = startSlope;
+    for (int i = distance; i <= sightRadius; i++) {
+        bool blocked = false;
+        int dy = -i;
+        for (int dx = -i; dx <= 0; dx++) {
+            int column = eye.column + dx * xx + dy * xy;
+            int row = eye.row + dx * yx + dy * yy;
+            float leftSlope = (dx - 0.5f) / (dy + 0.5f);
+            float rightSlope = (dx + 0.5f) / (dy - 0.5f);
+
+            if (startSlope < rightSlope) continue;
+            if (endSlope > leftSlope) break;
+
+            if (dx * dx + dy * dy <= radiusSquared && inBounds(row, column)) {
+                markVisible(row, column);
+            }
+
+            if (blocked) {
+                if (blocksSight(row, column)) {
+                    nextStart = rightSlope;
+                } else {
+                    blocked = false;
+                    startSlope = nextStart;
+                }
+            } else if (blocksSight(row, column) && i < sightRadius) {
+                blocked = true;
+                castLight(eye, i + 1, startSlope, leftSlope, xx, xy, yx, yy);
+                nextStart = rightSlope;
+            }
+        }
+        if (blocked) break;
+    }
+}
+
+/**
+ * @brief Page cold chunks out until the board fits its memory budget
+ *
+ * Pseudo-code:
+ * 1. IF no budget OR resident bytes within budget: RETURN
+ * 2. Work out the chunk range covering keep +/- max(keepRadius, sightRadius)
+ * 3. Collect (lastUsed, key) for every resident chunk outside that range
+ * 4. Sort by lastUsed, oldest first
+ * 5. FOR each candidate WHILE resident bytes > 3/4 of the budget: page it out
+ *
+ * @param keep Position to keep resident (normally the player)
+ * @param keepRadius Distance in squares around keep that is never evicted
+ */
+void Board::trimMemory(Position keep, int keepRadius) {
+    if (memoryBudget == 0 || residentBytes <= memoryBudget) return;
+
+    int radius = max(keepRadius, sightRadius);
+    long long firstRow = max(keep.row - radius, 0) / Chunk::SIZE;
+    long long lastRow = (keep.row + radius) / Chunk::SIZE;
+    long long firstColumn = max(keep.column - radius, 0) / Chunk::SIZE;
+    long long lastColumn = (keep.column + radius) / Chunk::SIZE;
+
+    evictionOrder.clear();
+    for (const auto& entry : chunks) {
+        long long chunkRow = entry.first >> 32;
+        long long chunkColumn = entry.first & 0xFFFFFFFFLL;
+        if (chunkRow >= firstRow && chunkRow <= lastRow &&
+            chunkColumn >= firstColumn && chunkColumn <= lastColumn) {
+            continue;
+        }
+        evictionOrder.push_back({entry.second->lastUsed, entry.first});
+    }
+    sort(evictionOrder.begin(), evictionOrder.end());
+
+    size_t target = memoryBudget / 4 * 3;
+    for (const auto& candidate : evictionOrder) {
+        if (residentBytes <= target) break;
+        pageOut(candidate.second);
+    }
+}
+
+/**
+ * @brief Write a resident chunk to the page file and free it
+ *
+ * Pseudo-code:
+ * 1. Encode the chunk into the page buffer
+ * 2. Write the buffer to the page file under the chunk key
+ * 3. IF write failed: keep the chunk resident, RETURN false
+ * 4. Forget the cached chunk pointer if it is this chunk
+ * 5. Free the chunk and update resident bytes
+ *
+ * @param key Chunk key
+ * @return true if the chunk was written and freed
+ */
+bool Board::pageOut(long long key) {
+    auto it = chunks.find(key);
+    if (it == chunks.end()) return false;
+
+    pageBuffer.clear();
+    ByteWriter out(pageBuffer);
+    writeChunk(out, *it->second);
+    if (!pageFile.write(key, pageBuffer)) {
+        cerr << "Could not write board page file" << endl;
+        return false;
+    }
+
+    if (lastChunkKey == key) {
+        lastChunkKey = -1;
+        lastChunk = nullptr;
+    }
+    residentBytes -= sizeof(Chunk);
+    if (it->second->path) residentBytes -= sizeof(Chunk::PathScratch);
+    chunks.erase(it);
+    return true;
+}
+
+/**
+ * @brief Bring every Orc of a chunk up to date with the time of day
+ *
+ * Chunks that are paged out or not yet decoded from a save keep the stats
+ * their Orcs had when written; setTimeOfDay() only reaches resident ones.
+ *
+ * @param chunk Chunk just decoded
+ * @param night Board's time of day
+ */
+static void setOrcsTimeOfDay(Chunk& chunk, bool night) {
+    for (Square& square : chunk.squares) {
+        if (Orc* orcPtr = dynamic_cast<Orc*>(square.enemy.get())) {
+            orcPtr->setTimeOfDay(night);
+        }
+    }
+}
+
+/**
+ * @brief Fill a freshly allocated chunk from its page file record
+ *
+ * Pseudo-code:
+ * 1. Read the chunk's record into the page buffer
+ * 2. Decode it into the chunk
+ * 3. Bring Orcs up to date with the board's time of day
+ *
+ * @param key Chunk key
+ * @param chunk Chunk to fill
+ */
+void Board::pageIn(long long key, Chunk& chunk) {
+    if (!pageFile.read(key, pageBuffer)) {
+        cerr << "Could not read board page file" << endl;
+        return;
+    }
+    ByteReader in(pageBuffer.data(), pageBuffer.size());
+    if (!readChunk(in, chunk)) {
+        cerr << "Board page file is damaged" << endl;
+    }
+    setOrcsTimeOfDay(chunk, night);
+}
+
+/**
+ * @brief Fill a freshly allocated chunk from the save file it was restored from
+ *
+ * Pseudo-code:
+ * 1. Decode the chunk's record straight out of the mapped save file
+ * 2. Bring Orcs up to date with the board's time of day
+ * 3. Forget the record (from now on the chunk lives in memory or the page file)
+ *
+ * @param key Chunk key
+ * @param chunk Chunk to fill
+ */
+void Board::restoreChunk(long long key, Chunk& chunk) {
+    auto it = snapshotChunks.find(key);
+    ByteReader in(it->second.first, it->second.second);
+    if (!readChunk(in, chunk)) {
+        cerr << "Save file is damaged" << endl;
     }
+    setOrcsTimeOfDay(chunk, night);
+    snapshotChunks.erase(it);
 }
@@ -2,10 +2,10 @@
  * @file board.hpp
  * @brief Board and Square classes for game grid management
  *
- * This file contains the Square class (representing individual board locations)
- * and the Board class (managing the game grid). All squares are dynamically
- * allocated and managed with smart pointers as required by the project
- * specifications.
+ * This file contains the Square class (representing individual board locations),
+ * the Chunk class (a fixed-size block of squares) and the Board class (managing
+ * the game grid). All squares are dynamically allocated, one chunk at a time,
+ * and managed with smart pointers as required by the project specifications.
  *
  * @author [Ish Soundankar]
  */
@@ -13,8 +13,15 @@
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <unordered_map>
+#include <algorithm>
 #include "characters.hpp"
 #include "items.hpp"
+#include "position.hpp"
+#include "spatial.hpp"
+#include "spawn.hpp"
+#include "pager.hpp"
 
 using namespace std;
 
@@ -45,47 +52,117 @@ public:
      * 4. IF square is empty: display "Square is empty!"
      */
     void printInfo() {
+        ostream& out = gameOut();
         if (enemy) {
-            cout << "Enemy here: " << endl;
+            out << "Enemy here: " << endl;
             enemy->printStats();
         }
         if (item) {
-            cout << "Item here: " << endl;
+            out << "Item here: " << endl;
             item->print();
         }
         if (player) {
-            cout << "Player here: " << endl;
+            out << "Player here: " << endl;
             player->printStats();
         }
         if (!enemy && !item && !player) {
-            cout << "Square is empty!" << endl;
+            out << "Square is empty!" << endl;
         }
     }
 };
 
+/**
+ * @class Chunk
+ * @brief Square block of CHUNK_SIZE x CHUNK_SIZE squares
+ *
+ * The board allocates chunks the first time one of their squares is used,
+ * so memory grows with the area that has actually been visited, and can
+ * write cold chunks out to its page file to stay within a memory budget.
+ * Per-square bookkeeping that used to be board-sized (visibility bits,
+ * route-finding scratch) lives in the chunk as well, and so does the
+ * terrain: a wall bit per square, set only on generated boards.
+ */
+class Chunk {
+public:
+    static const int SIZE = 64;  ///< Width/height of a chunk in squares
+
+    /**
+     * @struct PathScratch
+     * @brief Per-square A* state, only allocated for chunks a route has crossed
+     */
+    struct PathScratch {
+        unsigned stamp[SIZE * SIZE];       ///< Query stamp; other fields valid only when it matches Board::pathQuery
+        int cost[SIZE * SIZE];             ///< Best known cost from the start
+        unsigned char parent[SIZE * SIZE]; ///< Direction taken to reach the square on the best route
+    };
+
+    Square squares[SIZE * SIZE];   ///< Squares, row by row
+    uint64_t visible[SIZE] = {};   ///< Bit per square (one word per row): currently in view
+    uint64_t explored[SIZE] = {};  ///< Bit per square (one word per row): has ever been in view
+    uint64_t walls[SIZE] = {};     ///< Bit per square (one word per row): cannot be walked onto or seen through
+    unique_ptr<PathScratch> path;  ///< Route-finding scratch (nullptr until needed)
+    unsigned long long lastUsed = 0;  ///< Board::accessTick when the chunk was last switched to
+};
+
 /**
  * @class Board
  * @brief Class representing the game board
  *
- * The board is a 2D grid of Square objects, all dynamically allocated
- * and managed with smart pointers. The grid uses a vector of vectors
- * to store shared pointers to Square objects.
+ * The board is a 2D grid of Square objects split into chunks. Chunks are
+ * dynamically allocated on first access, owned by unique_ptr and looked up
+ * by chunk coordinate. A bounded board starts with empty squares and is
+ * filled by populateBoard(), or all at once from a world seed by
+ * generate(), which also grows cave walls (terrain.hpp) through it; both
+ * keep to the board's spawn rules (spawn.hpp). An endless board is an
+ * open field and generates each chunk's enemies and items from the world
+ * seed the first time it is touched. Either way the content depends only
+ * on the seed (and a bounded board's size), so the same seed always gives
+ * the same world.
+ *
+ * With a memoryBudget set, trimMemory() pages the least recently used
+ * chunks away from the player out to pageFile; chunkAt() faults them back
+ * in. Squares are only valid until the next trimMemory() call.
  */
 class Board {
 public:
+    static const int ENDLESS_SIZE = 1 << 30;      ///< Width/height used for endless boards
+    static const int ENEMIES_PER_CHUNK = 6;       ///< Enemies generated in each chunk of an endless board (at most, on a generated one)
+    static const int ITEMS_PER_CHUNK = 4;         ///< Items generated in each chunk of an endless board (at most, on a generated one)
+    static const int GENERATED_SPACING = 12;      ///< Least distance between two enemies, or two items, on a generated board
+    static const int VIEW_ROWS = 24;              ///< Rows shown by printBoard()
+    static const int VIEW_COLUMNS = 32;           ///< Columns shown by printBoard()
+
     int width;                                    ///< Width of the board (number of columns)
     int height;                                   ///< Height of the board (number of rows)
-    vector<vector<shared_ptr<Square>>> grid;      ///< 2D grid of squares
+    bool endless;                                 ///< true if chunks generate their own content
+    unsigned seed;                                ///< World seed for endless boards
+    bool night = false;                           ///< Time of day applied to Orcs (including newly generated ones)
+    bool walled = false;                          ///< Whether the board has walls at all (set by generate())
+    SpawnRules spawnRules;                        ///< Where populateBoard() and generate() may place enemies and items
+    unordered_map<long long, unique_ptr<Chunk>> chunks;  ///< Allocated chunks by chunk coordinate
+    long long lastChunkKey = -1;                  ///< Key of the most recently used chunk
+    Chunk* lastChunk = nullptr;                   ///< Most recently used chunk (saves a hash lookup)
+    unsigned long long accessTick = 0;            ///< Counter stamped into Chunk::lastUsed
+    size_t memoryBudget = 0;                      ///< Bytes of chunks to keep resident (0 = no limit)
+    size_t residentBytes = 0;                     ///< Bytes of chunks (and their scratch) in memory
+    PageFile pageFile;                            ///< Where evicted chunks are kept
+    vector<char> pageBuffer;                      ///< Reused encode/decode buffer for paging
+    vector<pair<unsigned long long, long long>> evictionOrder;  ///< Reused (lastUsed, key) list for trimMemory()
+    shared_ptr<MappedFile> snapshotFile;          ///< Save game this board was restored from (nullptr if none)
+    unordered_map<long long, pair<const char*, uint32_t>> snapshotChunks;  ///< Chunk records in snapshotFile not yet decoded
+    SpatialIndex enemyIndex;                      ///< Positions of every enemy on the board
+    SpatialIndex itemIndex;                       ///< Positions of every item on the board
+    bool fogOfWar = false;                        ///< Hide squares the player cannot see in printBoard()
+    int sightRadius = 5;                          ///< How far the player can see (in squares)
+    static const int MAX_SIGHT_RADIUS = 64;       ///< Largest sightRadius a save file may set
+    vector<Position> visibleSquares;              ///< Squares currently marked visible, so the next update can clear just those
+    vector<Position> newEnemies;                  ///< Reused by generateChunk() for the enemies fillChunk() placed
+    vector<Position> newItems;                    ///< Reused by generateChunk() for the items fillChunk() placed
 
     /**
      * @brief Constructor to create a board of specified dimensions
      *
-     * Pseudo-code:
-     * 1. Set width and height
-     * 2. Resize outer vector to match height
-     * 3. FOR each row:
-     *    a. Resize inner vector to match width
-     *    b. FOR each column: create new Square using make_shared
+     * No squares are allocated here; chunks are created empty on first access.
      *
      * @param w Width of the board
      * @param h Height of the board
@@ -93,47 +170,433 @@ public:
     Board(int w, int h) {
         width = w;
         height = h;
-        grid.resize(height);
-        for (int i = 0; i < height; ++i) {
-            grid[i].resize(width);
-            for (int j = 0; j < width; j++) {
-                grid[i][j] = make_shared<Square>();
+        endless = false;
+        seed = 0;
+    }
+
+    /**
+     * @brief Constructor to create an endless, procedurally generated board
+     *
+     * @param worldSeed Seed every chunk's content is derived from
+     */
+    Board(unsigned worldSeed) {
+        width = ENDLESS_SIZE;
+        height = ENDLESS_SIZE;
+        endless = true;
+        seed = worldSeed;
+    }
+
+    /**
+     * @brief Key identifying the chunk that contains a square
+     */
+    static long long chunkKey(int row, int column) {
+        return ((long long)(row / Chunk::SIZE) << 32) | (column / Chunk::SIZE);
+    }
+
+    /**
+     * @brief Get the chunk containing a square, allocating it if needed
+     *
+     * A chunk that was paged out is read back from the page file, a chunk
+     * of a restored game is decoded from the save file, and a new chunk of
+     * an endless board is generated.
+     *
+     * @param row Row index (must be on the board)
+     * @param column Column index (must be on the board)
+     * @return Reference to the chunk
+     */
+    Chunk& chunkAt(int row, int column) {
+        long long key = chunkKey(row, column);
+        if (key == lastChunkKey) return *lastChunk;
+        unique_ptr<Chunk>& slot = chunks[key];
+        if (!slot) {
+            slot = make_unique<Chunk>();
+            residentBytes += sizeof(Chunk);
+            if (pageFile.contains(key)) {
+                pageIn(key, *slot);
+            } else if (snapshotChunks.count(key)) {
+                restoreChunk(key, *slot);
+            } else if (endless) {
+                generateChunk(row / Chunk::SIZE, column / Chunk::SIZE, *slot);
             }
         }
+        slot->lastUsed = ++accessTick;
+        lastChunkKey = key;
+        lastChunk = slot.get();
+        return *slot;
+    }
+
+    /**
+     * @brief Page cold chunks out until the board fits its memory budget
+     *
+     * Chunks within keepRadius squares of keep (and within sight) stay
+     * resident. Trims to three quarters of the budget so that a board
+     * hovering at the limit does not page on every turn.
+     *
+     * @param keep Position to keep resident (normally the player)
+     * @param keepRadius Distance in squares around keep that is never evicted
+     */
+    void trimMemory(Position keep, int keepRadius = Chunk::SIZE);
+
+    /**
+     * @brief Write a resident chunk to the page file and free it
+     *
+     * @param key Chunk key
+     * @return true if the chunk was written and freed
+     */
+    bool pageOut(long long key);
+
+    /**
+     * @brief Fill a freshly allocated chunk from its page file record
+     *
+     * @param key Chunk key
+     * @param chunk Chunk to fill
+     */
+    void pageIn(long long key, Chunk& chunk);
+
+    /**
+     * @brief Fill a freshly allocated chunk from the save file it was restored from
+     *
+     * @param key Chunk key
+     * @param chunk Chunk to fill
+     */
+    void restoreChunk(long long key, Chunk& chunk);
+
+    /**
+     * @brief Get the chunk containing a square without allocating it
+     *
+     * @return Pointer to the chunk, or nullptr if it was never used
+     */
+    const Chunk* findChunk(int row, int column) const {
+        auto it = chunks.find(chunkKey(row, column));
+        return it == chunks.end() ? nullptr : it->second.get();
     }
 
     /**
-     * @brief Print the board in ASCII format
+     * @brief Access a square
+     *
+     * @param row Row index (must be on the board)
+     * @param column Column index (must be on the board)
+     * @return Reference to the square
+     */
+    Square& at(int row, int column) {
+        return chunkAt(row, column).squares[(row % Chunk::SIZE) * Chunk::SIZE + column % Chunk::SIZE];
+    }
+
+    /**
+     * @brief Fill a freshly allocated chunk of an endless board
+     *
+     * @param chunkRow Chunk row (row / Chunk::SIZE)
+     * @param chunkColumn Chunk column (column / Chunk::SIZE)
+     * @param chunk Chunk to fill
+     */
+    void generateChunk(int chunkRow, int chunkColumn, Chunk& chunk);
+
+    /**
+     * @brief Place a chunk's enemies and items, derived from the seed and its coordinates
+     *
+     * Only reads the board (seed, size, time of day); the caller adds what
+     * was placed to the board's indexes. Squares outside the board are left
+     * empty.
+     *
+     * @param chunkRow Chunk row (row / Chunk::SIZE)
+     * @param chunkColumn Chunk column (column / Chunk::SIZE)
+     * @param chunk Chunk to fill (empty)
+     * @param enemies Board positions of the enemies placed are appended here
+     * @param items Board positions of the items placed are appended here
+     */
+    void fillChunk(int chunkRow, int chunkColumn, Chunk& chunk,
+                   vector<Position>& enemies, vector<Position>& items) const;
+
+    /**
+     * @brief Create the enemies and items planned for a chunk of a generated board
+     *
+     * Their races, names and kinds are drawn from the chunk's own random
+     * stream, as fillChunk()'s are. Only reads the board, so chunks can be
+     * stocked on several threads at once.
+     *
+     * @param chunkRow Chunk row (row / Chunk::SIZE)
+     * @param chunkColumn Chunk column (column / Chunk::SIZE)
+     * @param chunk Chunk to fill (empty apart from its walls)
+     * @param enemies Board positions of the chunk's enemies
+     * @param enemyCount Number of enemies
+     * @param items Board positions of the chunk's items
+     * @param itemCount Number of items
+     */
+    void stockChunk(int chunkRow, int chunkColumn, Chunk& chunk, const Position* enemies,
+                    size_t enemyCount, const Position* items, size_t itemCount) const;
+
+    /**
+     * @brief Allocate and fill every chunk of a bounded board from a world seed
+     *
+     * The board's caves are grown first (CaveMap, on this thread); then the
+     * chunk rows are split into one band per thread. Each band's thread
+     * plans where the enemies and items of its chunk rows go (SpawnSampler,
+     * in time linear in the squares), creates its chunks and stocks them
+     * with stockChunk(); the chunks are then handed to the board in row
+     * order. Chunk rows and chunks draw from their own random streams, so
+     * the board is the same whatever the thread count.
+     * The board must not have any chunks yet.
+     *
+     * @param worldSeed Seed every chunk's content is derived from
+     * @param threads Threads to use (0: one per hardware thread)
+     */
+    void generate(unsigned worldSeed, int threads = 0);
+
+    /**
+     * @brief Print the part of the board around a position in ASCII format
      *
      * Pseudo-code:
-     * 1. FOR each row:
-     *    a. FOR each column:
+     * 1. Choose a VIEW_ROWS x VIEW_COLUMNS window centred on center, clamped to the board
+     * 2. FOR each row of the window:
+     *    a. FOR each column of the window:
      *       - IF player present: print "#"
      *       - ELSE IF enemy present: print "*"
      *       - ELSE IF item present: print "+"
+     *       - ELSE IF wall: print "%"
      *       - ELSE: print space
      *       - Print "|" separator
      *    b. Print newline
      *
-     * Symbols: # = player, * = enemy, + = item, space = empty
+     * With fogOfWar on, squares that are not in view never show enemies,
+     * explored squares still show items and walls, and unexplored squares
+     * print "?".
+     * Boards no bigger than the window are printed whole.
+     *
+     * Symbols: # = player, * = enemy, + = item, % = wall, space = empty, ? = unexplored
+     *
+     * @param center Square to centre the window on (normally the player)
      */
-    void printBoard() {
-        for (int i = 0; i < height; ++i) {
-            for (int j = 0; j < width; j++) {
-                cout << "|" << (grid[i][j]->player ? "#" :
-                                    (grid[i][j]->enemy ? "*" :
-                                         (grid[i][j]->item ? "+" : " "))) << "|";
+    void printBoard(Position center) {
+        ostream& out = gameOut();
+        if (!out) return;
+        int rows = height < VIEW_ROWS ? height : VIEW_ROWS;
+        int columns = width < VIEW_COLUMNS ? width : VIEW_COLUMNS;
+        int top = clampStart(center.row - rows / 2, rows, height);
+        int left = clampStart(center.column - columns / 2, columns, width);
+
+        for (int i = top; i < top + rows; ++i) {
+            for (int j = left; j < left + columns; j++) {
+                Square& square = at(i, j);
+                const char* ground = isWall(i, j) ? "%" : " ";
+                if (fogOfWar && !isVisible(i, j)) {
+                    out << "|" << (!isExplored(i, j) ? "?" :
+                                       (square.item ? "+" : ground)) << "|";
+                    continue;
+                }
+                out << "|" << (square.player ? "#" :
+                                   (square.enemy ? "*" :
+                                        (square.item ? "+" : ground))) << "|";
             }
-            cout << endl;
+            out << endl;
         }
     }
 
+    /**
+     * @brief First index of a window of a given length kept inside [0, limit)
+     */
+    static int clampStart(int start, int length, int limit) {
+        if (start > limit - length) start = limit - length;
+        return start < 0 ? 0 : start;
+    }
+
     /**
      * @brief Populate board with enemies and items
      *
      * @param enemies Vector of enemy characters to place
      * @param items Vector of items to place
      */
-    void populateBoard(const vector<shared_ptr<Character>> enemies,
-                       const vector<shared_ptr<Item>> items);
+    void populateBoard(const vector<shared_ptr<Character>>& enemies,
+                       const vector<shared_ptr<Item>>& items);
+
+    /**
+     * @brief Put an enemy on a square and record it in the enemy index
+     *
+     * @param row Row index
+     * @param column Column index
+     * @param enemy Enemy to place (square must not already hold one)
+     */
+    void placeEnemy(int row, int column, const shared_ptr<Character>& enemy) {
+        at(row, column).enemy = enemy;
+        COUNT_SHARED_COPY(1);
+        enemyIndex.insert({row, column});
+    }
+
+    /**
+     * @brief Take the enemy off a square (e.g. when it is defeated)
+     *
+     * @param row Row index
+     * @param column Column index
+     */
+    void removeEnemy(int row, int column) {
+        Square& square = at(row, column);
+        if (square.enemy) {
+            square.enemy = nullptr;
+            enemyIndex.remove({row, column});
+        }
+    }
+
+    /**
+     * @brief Put an item on a square and record it in the item index
+     *
+     * @param row Row index
+     * @param column Column index
+     * @param item Item to place (square must not already hold one)
+     */
+    void placeItem(int row, int column, const shared_ptr<Item>& item) {
+        at(row, column).item = item;
+        COUNT_SHARED_COPY(1);
+        itemIndex.insert({row, column});
+    }
+
+    /**
+     * @brief Take the item off a square (e.g. when it is picked up)
+     *
+     * @param row Row index
+     * @param column Column index
+     */
+    void removeItem(int row, int column) {
+        Square& square = at(row, column);
+        if (square.item) {
+            square.item = nullptr;
+            itemIndex.remove({row, column});
+        }
+    }
+
+    /**
+     * @brief Switch every Orc on the board between day and night stats
+     *
+     * Only squares holding enemies are visited (via the enemy index), and
+     * only in resident chunks; paged-out Orcs are updated when paged in.
+     *
+     * @param isNight true if it's night, false if it's day
+     */
+    void setTimeOfDay(bool isNight);
+
+    /**
+     * @brief Check whether a coordinate lies on the board
+     *
+     * @param row Row index
+     * @param column Column index
+     * @return true if (row, column) is inside the grid
+     */
+    bool inBounds(int row, int column) const {
+        return row >= 0 && row < height && column >= 0 && column < width;
+    }
+
+    /**
+     * @struct PathNode
+     * @brief Entry in the A* open list
+     */
+    struct PathNode {
+        int estimate;  ///< Cost so far plus heuristic (f)
+        int cost;      ///< Cost so far (g)
+        int row;       ///< Row of the square
+        int column;    ///< Column of the square
+    };
+
+    unsigned pathQuery = 0;            ///< Stamp of the current findPath() query
+    int pathSearchLimit = 1 << 22;     ///< Squares findPath() may expand before giving up
+    vector<PathNode> pathOpen;         ///< Binary min-heap of squares still to expand
+
+    /**
+     * @brief Find the shortest walking route between two squares (A*)
+     *
+     * Uses 4-way movement around walls and the Manhattan distance heuristic. Scratch
+     * storage lives in the chunks and the open list on the board; both are
+     * reused between queries, so once an area has been routed through
+     * further calls do not allocate (as long as path already has enough
+     * capacity). Gives up after pathSearchLimit squares.
+     *
+     * @param from Starting square
+     * @param to Destination square
+     * @param path Filled with the squares to step through, excluding from and
+     *             including to (empty if from == to or no route exists)
+     * @return true if a route was found
+     */
+    bool findPath(Position from, Position to, vector<Position>& path);
+
+    /**
+     * @brief Route-finding scratch for the chunk containing a square
+     *
+     * Allocates the scratch the first time the chunk is routed through.
+     */
+    Chunk::PathScratch& pathScratchAt(int row, int column) {
+        Chunk& chunk = chunkAt(row, column);
+        if (!chunk.path) {
+            chunk.path = make_unique<Chunk::PathScratch>();
+            residentBytes += sizeof(Chunk::PathScratch);
+            fill(begin(chunk.path->stamp), end(chunk.path->stamp), 0u);
+        }
+        return *chunk.path;
+    }
+
+    /**
+     * @brief Check whether a square is currently in the player's view
+     */
+    bool isVisible(int row, int column) const {
+        const Chunk* chunk = findChunk(row, column);
+        return chunk && ((chunk->visible[row % Chunk::SIZE] >> (column % Chunk::SIZE)) & 1);
+    }
+
+    /**
+     * @brief Check whether a square has ever been in the player's view
+     */
+    bool isExplored(int row, int column) const {
+        const Chunk* chunk = findChunk(row, column);
+        return chunk && ((chunk->explored[row % Chunk::SIZE] >> (column % Chunk::SIZE)) & 1);
+    }
+
+    /**
+     * @brief Check whether a square is a wall (must be on the board)
+     *
+     * Boards without walls answer without looking the chunk up.
+     */
+    bool isWall(int row, int column) {
+        return walled && ((chunkAt(row, column).walls[row % Chunk::SIZE] >> (column % Chunk::SIZE)) & 1);
+    }
+
+    /**
+     * @brief Check whether a square stops line of sight
+     *
+     * Walls and the edge of the board block sight.
+     */
+    bool blocksSight(int row, int column) {
+        return !inBounds(row, column) || isWall(row, column);
+    }
+
+    /**
+     * @brief Recompute which squares are in view from a position
+     *
+     * Only the squares lit by the previous update are cleared, so the cost
+     * depends on sightRadius rather than on the board size.
+     *
+     * @param eye Position the player is looking from
+     */
+    void updateFieldOfView(Position eye);
+
+    /**
+     * @brief Scan one octant for updateFieldOfView() (recursive shadowcasting)
+     *
+     * @param eye Position being looked from
+     * @param distance First row of the octant to scan
+     * @param startSlope Slope where the visible arc starts
+     * @param endSlope Slope where the visible arc ends
+     * @param xx,xy,yx,yy Transform from octant coordinates to board offsets
+     */
+    void castLight(Position eye, int distance, float startSlope, float endSlope,
+                   int xx, int xy, int yx, int yy);
+
+    /**
+     * @brief Mark a square as in view (and therefore explored)
+     */
+    void markVisible(int row, int column) {
+        Chunk& chunk = chunkAt(row, column);
+        uint64_t mask = (uint64_t)1 << (column % Chunk::SIZE);
+        uint64_t& word = chunk.visible[row % Chunk::SIZE];
+        if (!(word & mask)) {
+            word |= mask;
+            chunk.explored[row % Chunk::SIZE] |= mask;
+            visibleSquares.push_back({row, column});
+        }
+    }
 };
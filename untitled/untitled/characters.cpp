@@ -2,23 +2,29 @@
  * @file characters.cpp
  * @brief Implementation of race-specific successful defense behaviors
  *
- * This file contains the implementations of the successfulDef() method for
- * each race, providing unique defensive behaviors when a character
- * successfully defends against an attack.
+ * This file contains the race-specific defensive behaviors run when a
+ * character successfully defends against an attack: each race's defend()
+ * handler, and Character::successfulDef(), which picks the handler of the
+ * defender's race from the raceDefences table.
  *
  * @author [Steffy Pereppadan Ignatious]
  */
 #include "characters.hpp"
 #include <iostream>
-#include <cstdlib> // for rand()
+#include "random.hpp"
 
 /**
- * @brief Base class successful defense handler (empty implementation)
+ * @brief Handle successful defense (race-specific behavior)
  *
- * @param attacker Character that initiated the attack (unused)
- * @param defender Character that successfully defended (unused)
+ * Pseudo-code:
+ * 1. Look up the defend() handler of this character's race in raceDefences
+ * 2. Call it
+ *
+ * @param attacker Character that initiated the attack
+ * @param defender Character that successfully defended (this character)
  */
-void Character::successfulDef(Character*, Character*) {
+void Character::successfulDef(Character* attacker, Character* defender) {
+    raceDefences[raceId](attacker, defender);
 }
 
 /**
@@ -30,8 +36,8 @@ void Character::successfulDef(Character*, Character*) {
  * @param attacker Character that initiated the attack (unused)
  * @param defender Human character that successfully defended
  */
-void Human::successfulDef(Character*, Character* defender) {
-    cout << defender->name << " defended successfully!" << endl;
+void Human::defend(Character*, Character* defender) {
+    gameOut() << defender->name << " defended successfully!" << endl;
 }
 
 /**
@@ -45,10 +51,10 @@ void Human::successfulDef(Character*, Character* defender) {
  * @param attacker Character that initiated the attack (unused)
  * @param defender Elf character that successfully defended
  */
-void Elf::successfulDef(Character*, Character* defender) {
-    cout << defender->name << " defended successfully!" << endl;
+void Elf::defend(Character*, Character* defender) {
+    gameOut() << defender->name << " defended successfully!" << endl;
     defender->health += 1;
-    cout << defender->name << " health increased to " << defender->health << endl;
+    gameOut() << defender->name << " health increased to " << defender->health << endl;
 }
 
 /**
@@ -60,8 +66,8 @@ void Elf::successfulDef(Character*, Character* defender) {
  * @param attacker Character that initiated the attack (unused)
  * @param defender Dwarf character that successfully defended
  */
-void Dwarf::successfulDef(Character*, Character* defender) {
-    cout << defender->name << " defended successfully!" << endl;
+void Dwarf::defend(Character*, Character* defender) {
+    gameOut() << defender->name << " defended successfully!" << endl;
 }
 
 /**
@@ -77,11 +83,11 @@ void Dwarf::successfulDef(Character*, Character* defender) {
  * @param attacker Character that initiated the attack (unused)
  * @param defender Hobbit character that successfully defended
  */
-void Hobbit::successfulDef(Character*, Character* defender) {
-    cout << defender->name << " defended successfully!" << endl;
-    defender->health -= rand() % 6;
+void Hobbit::defend(Character*, Character* defender) {
+    gameOut() << defender->name << " defended successfully!" << endl;
+    defender->health -= gameRandom().nextInt(6);
     if (defender->health < 0) defender->health = 0;
-    cout << defender->name << " health reduced to " << defender->health << endl;
+    gameOut() << defender->name << " health reduced to " << defender->health << endl;
 }
 
 /**
@@ -101,8 +107,8 @@ void Hobbit::successfulDef(Character*, Character* defender) {
  * @param attacker Character that initiated the attack
  * @param defender Orc character that successfully defended
  */
-void Orc::successfulDef(Character* attacker, Character* defender) {
-    if (!isNight) {
+void Orc::defend(Character* attacker, Character* defender) {
+    if (!static_cast<Orc*>(defender)->isNight) {
         int temp = attacker->attack - defender->defence;
         if (temp < 0) temp = 0;
         int damageTaken = temp / 4;  // quarter damage
@@ -110,6 +116,6 @@ void Orc::successfulDef(Character* attacker, Character* defender) {
         if (defender->health < 0) defender->health = 0;
     } else {
         defender->health += 1;
-        cout << defender->name << " health increased to " << defender->health << endl;
+        gameOut() << defender->name << " health increased to " << defender->health << endl;
     }
 }
@@ -5,7 +5,7 @@
  * This file contains the abstract base Character class and all race-specific
  * implementations (Human, Elf, Dwarf, Hobbit, Orc). Characters can equip items
  * and have race-specific combat behaviors. The Character class uses polymorphism
- * through the pure virtual printStats() method.
+ * through the pure virtual formatStats() method.
  *
  * @author [Steffy Pereppadan Ignatious]
  */
@@ -14,6 +14,9 @@
 #include <string>
 #include <vector>
 #include "items.hpp"
+#include "textbuffer.hpp"
+#include "counters.hpp"
+#include "races.hpp"
 using namespace std;
 
 /**
@@ -22,13 +25,14 @@ using namespace std;
  *
  * This class provides the base functionality for all characters including
  * stats, inventory management, and combat calculations. It uses polymorphism
- * through the pure virtual printStats() method. Characters can carry an
+ * through the pure virtual formatStats() method. Characters can carry an
  * unbounded amount of items (limited by strength) using dynamic data structures.
  */
 class Character {
 public:
-    string name;                    ///< Character's name
-    string race;                    ///< Character's race (Human, Elf, Dwarf, Hobbit, Orc)
+    InternedString name;            ///< Character's name (interned)
+    InternedString race;            ///< Character's race (Human, Elf, Dwarf, Hobbit, Orc; interned)
+    RaceId raceId;                  ///< Character's race as a number
     int attack;                     ///< Base attack value
     float attack_chance;            ///< Probability of successful attack (0.0 to 1.0)
     int defence;                    ///< Base defense value
@@ -45,31 +49,39 @@ public:
      * @brief Constructor to initialize character attributes
      *
      * @param n Character's name
-     * @param r Character's race
-     * @param a Base attack value
-     * @param ac Attack chance (0.0 to 1.0)
-     * @param d Base defense value
-     * @param dc Defense chance (0.0 to 1.0)
-     * @param h Base health points
-     * @param s Base strength value
+     * @param id Character's race
+     * @param s Base stats of the race (from its RaceTraits)
      */
-    Character(string n, string r, int a, float ac, int d, float dc, int h, int s) {
+    Character(string n, RaceId id, const RaceStats& s) {
         name = n;
-        race = r;
-        attack = a;
-        attack_chance = ac;
-        defence = d;
-        defence_chance = dc;
-        health = h;
-        strength = s;
+        race = s.name;
+        raceId = id;
+        attack = s.attack;
+        attack_chance = s.attackChance;
+        defence = s.defence;
+        defence_chance = s.defenceChance;
+        health = s.health;
+        strength = s.strength;
     }
 
     /**
-     * @brief Pure virtual function to print character statistics
+     * @brief Pure virtual function to format character statistics
      *
      * Must be implemented by derived classes to display race-specific stats.
+     *
+     * @param out Buffer the line is formatted into
      */
-    virtual void printStats() = 0;
+    virtual void formatStats(TextBuffer& out) const = 0;
+
+    /**
+     * @brief Print character statistics (formatStats() written to gameOut() in one go)
+     */
+    void printStats() const {
+        ostream& out = gameOut();
+        if (!out) return;
+        TextLine<256> line(out);
+        formatStats(line);
+    }
 
     shared_ptr<Item> item;  ///< Temporary item pointer (used during pickup)
 
@@ -106,13 +118,15 @@ public:
      * @param item Pointer to item to pick up
      * @return true if item was successfully picked up, false otherwise
      */
-    bool pickUp(shared_ptr<Item> item) {
+    bool pickUp(const shared_ptr<Item>& item) {
+        ostream& out = gameOut();
         if (getCurrentWeight() + item->weight > strength) {
-            cout << "Item too heavy" << endl;
+            out << "Item too heavy" << endl;
             return false;
         }
         if (auto w = dynamic_pointer_cast<Weapon>(item)) {
             weapon = w;
+            COUNT_SHARED_COPY(2);
             w->print();
             return true;
         }
@@ -120,21 +134,24 @@ public:
             armor = a;
             a->print();
             inventory.push_back(item);
+            COUNT_SHARED_COPY(3);
             return true;
         }
         if (auto s = dynamic_pointer_cast<Shield>(item)) {
             shield = s;
             s->print();
             inventory.push_back(item);
+            COUNT_SHARED_COPY(3);
             return true;
         }
         if (auto r = dynamic_pointer_cast<Ring>(item)) {
             ring.push_back(r);
             r->print();
             inventory.push_back(item);
+            COUNT_SHARED_COPY(3);
             return true;
         }
-        cout << "Item not recognized." << endl;
+        out << "Item not recognized." << endl;
         return false;
     }
 
@@ -152,31 +169,33 @@ public:
      *    b. FOR each ring in vector: display numbered ring info
      */
     void printInventory() {
-        cout << "Equipped Items:" << endl;
+        ostream& out = gameOut();
+        if (!out) return;
+        out << "Equipped Items:" << endl;
         if (weapon) {
-            cout << "Weapon: ";
+            out << "Weapon: ";
             weapon->print();
         } else {
-            cout << "Weapon: None" << endl;
+            out << "Weapon: None" << endl;
         }
         if (armor) {
-            cout << "Armour: ";
+            out << "Armour: ";
             armor->print();
         } else {
-            cout << "Armour: None" << endl;
+            out << "Armour: None" << endl;
         }
         if (shield) {
-            cout << "Shield: ";
+            out << "Shield: ";
             shield->print();
         } else {
-            cout << "Shield: None" << endl;
+            out << "Shield: None" << endl;
         }
         if (ring.empty()) {
-            cout << "Rings: None" << endl;
+            out << "Rings: None" << endl;
         } else {
-            cout << "Rings:" << endl;
+            out << "Rings:" << endl;
             for (size_t i = 0; i < ring.size(); ++i) {
-                cout << "  " << i+1 << ". ";
+                out << "  " << i+1 << ". ";
                 ring[i]->print();
             }
         }
@@ -185,6 +204,9 @@ public:
     /**
      * @brief Handle successful defense (race-specific behavior)
      *
+     * Calls the defend() handler of the character's race through the
+     * raceDefences table, indexed by raceId (no virtual call, no RTTI).
+     *
      * @param attacker Character that initiated the attack
      * @param defender Character that successfully defended
      */
@@ -289,10 +311,10 @@ public:
      */
     void dropWeapon() {
         if (weapon) {
-            cout << "Dropping weapon: " << weapon->name << endl;
+            gameOut() << "Dropping weapon: " << weapon->name << endl;
             weapon = nullptr;
         } else {
-            cout << "No weapon to drop.\n";
+            gameOut() << "No weapon to drop.\n";
         }
     }
 
@@ -301,10 +323,10 @@ public:
      */
     void dropArmour() {
         if (armor) {
-            cout << "Dropping armor: " << armor->name << endl;
+            gameOut() << "Dropping armor: " << armor->name << endl;
             armor = nullptr;
         } else {
-            cout << "No armor to drop.\n";
+            gameOut() << "No armor to drop.\n";
         }
     }
 
@@ -313,10 +335,10 @@ public:
      */
     void dropShield() {
         if (shield) {
-            cout << "Dropping shield: " << shield->name << endl;
+            gameOut() << "Dropping shield: " << shield->name << endl;
             shield = nullptr;
         } else {
-            cout << "No shield to drop.\n";
+            gameOut() << "No shield to drop.\n";
         }
     }
 
@@ -327,10 +349,10 @@ public:
      */
     void dropRing(int index) {
         if (index >= 0 && index < (int)ring.size()) {
-            cout << "Dropping ring: " << ring[index]->name << endl;
+            gameOut() << "Dropping ring: " << ring[index]->name << endl;
             ring.erase(ring.begin() + index);
         } else {
-            cout << "Invalid ring choice.\n";
+            gameOut() << "Invalid ring choice.\n";
         }
     }
 };
@@ -348,18 +370,24 @@ public:
      *
      * @param n Character's name
      */
-    Human(string n) : Character(n, "Human", 30, 2.0/3.0, 20, 1.0/2.0, 60, 100) {}
+    Human(string n) : Character(n, HumanTraits::id, HumanTraits::stats) {}
 
     /**
-     * @brief Print Human character statistics
+     * @brief Format Human character statistics
      */
-    virtual void printStats() override {
-        cout << name << ", race: " << race << ", attack: " << getTotalAttack()
+    void formatStats(TextBuffer& out) const override {
+        out << name << ", race: " << race << ", attack: " << getTotalAttack()
         << ", defence: " << getTotalDefence() << ", health: " << getTotalHealth()
-        << ", strength: " << getTotalStrength() << endl;
+        << ", strength: " << getTotalStrength() << '\n';
     }
 
-    void successfulDef(Character* attacker, Character* defender);
+    /**
+     * @brief Human's reaction to a successful defense (see Character::successfulDef())
+     *
+     * @param attacker Character that initiated the attack
+     * @param defender Human character that successfully defended
+     */
+    static void defend(Character* attacker, Character* defender);
 };
 
 /**
@@ -375,18 +403,24 @@ public:
      *
      * @param n Character's name
      */
-    Elf(string n) : Character(n, "Elf", 40, 1.0/1.0, 10, 1.0/4.0, 40, 70) {}
+    Elf(string n) : Character(n, ElfTraits::id, ElfTraits::stats) {}
 
     /**
-     * @brief Print Elf character statistics
+     * @brief Format Elf character statistics
      */
-    virtual void printStats() override {
-        cout << name << ", race: " << race << ", attack: " << getTotalAttack()
+    void formatStats(TextBuffer& out) const override {
+        out << name << ", race: " << race << ", attack: " << getTotalAttack()
         << ", defence: " << getTotalDefence() << ", health: " << getTotalHealth()
-        << ", strength: " << getTotalStrength() << endl;
+        << ", strength: " << getTotalStrength() << '\n';
     }
 
-    void successfulDef(Character* attacker, Character* defender);
+    /**
+     * @brief Elf's reaction to a successful defense (see Character::successfulDef())
+     *
+     * @param attacker Character that initiated the attack
+     * @param defender Elf character that successfully defended
+     */
+    static void defend(Character* attacker, Character* defender);
 };
 
 /**
@@ -402,18 +436,24 @@ public:
      *
      * @param n Character's name
      */
-    Dwarf(string n) : Character(n, "Dwarf", 30, 2.0/3.0, 20, 2.0/3.0, 50, 130) {}
+    Dwarf(string n) : Character(n, DwarfTraits::id, DwarfTraits::stats) {}
 
     /**
-     * @brief Print Dwarf character statistics
+     * @brief Format Dwarf character statistics
      */
-    virtual void printStats() override {
-        cout << name << ", race: " << race << ", attack: " << getTotalAttack()
+    void formatStats(TextBuffer& out) const override {
+        out << name << ", race: " << race << ", attack: " << getTotalAttack()
         << ", defence: " << getTotalDefence() << ", health: " << getTotalHealth()
-        << ", strength: " << getTotalStrength() << endl;
+        << ", strength: " << getTotalStrength() << '\n';
     }
 
-    void successfulDef(Character* attacker, Character* defender);
+    /**
+     * @brief Dwarf's reaction to a successful defense (see Character::successfulDef())
+     *
+     * @param attacker Character that initiated the attack
+     * @param defender Dwarf character that successfully defended
+     */
+    static void defend(Character* attacker, Character* defender);
 };
 
 /**
@@ -429,18 +469,24 @@ public:
      *
      * @param n Character's name
      */
-    Hobbit(string n) : Character(n, "Hobbit", 25, 1.0/3.0, 20, 2.0/3.0, 70, 85) {}
+    Hobbit(string n) : Character(n, HobbitTraits::id, HobbitTraits::stats) {}
 
     /**
-     * @brief Print Hobbit character statistics
+     * @brief Format Hobbit character statistics
      */
-    virtual void printStats() override {
-        cout << name << ", race: " << race << ", attack: " << getTotalAttack()
+    void formatStats(TextBuffer& out) const override {
+        out << name << ", race: " << race << ", attack: " << getTotalAttack()
         << ", defence: " << getTotalDefence() << ", health: " << getTotalHealth()
-        << ", strength: " << getTotalStrength() << endl;
+        << ", strength: " << getTotalStrength() << '\n';
     }
 
-    void successfulDef(Character* attacker, Character* defender);
+    /**
+     * @brief Hobbit's reaction to a successful defense (see Character::successfulDef())
+     *
+     * @param attacker Character that initiated the attack
+     * @param defender Hobbit character that successfully defended
+     */
+    static void defend(Character* attacker, Character* defender);
 };
 
 /**
@@ -461,50 +507,52 @@ public:
      *
      * @param n Character's name
      */
-    Orc(string n) : Character(n, "Orc", 25, 0.25, 10, 0.25, 50, 130), isNight(false) {}
+    Orc(string n) : Character(n, OrcDay::id, OrcDay::stats), isNight(false) {}
 
     /**
      * @brief Update Orc stats based on time of day
      *
      * Pseudo-code:
      * 1. Set isNight flag
-     * 2. IF it's night:
-     *    a. Set attack to 45
-     *    b. Set attack_chance to 1.0
-     *    c. Set defence to 25
-     *    d. Set defence_chance to 0.5
-     * 3. ELSE (it's day):
-     *    a. Set attack to 25
-     *    b. Set attack_chance to 0.25
-     *    c. Set defence to 10
-     *    d. Set defence_chance to 0.25
+     * 2. Take the night (OrcNight) or day (OrcDay) stats
+     * 3. Set attack, attack_chance, defence and defence_chance from them
      *
      * @param night true if it's night, false if it's day
      */
     void setTimeOfDay(bool night) {
         isNight = night;
-        if (isNight) {
-            attack = 45;
-            attack_chance = 1.0;
-            defence = 25;
-            defence_chance = 0.5;
-        } else {
-            attack = 25;
-            attack_chance = 0.25;
-            defence = 10;
-            defence_chance = 0.25;
-        }
+        const RaceStats& stats = isNight ? OrcNight::stats : OrcDay::stats;
+        attack = stats.attack;
+        attack_chance = stats.attackChance;
+        defence = stats.defence;
+        defence_chance = stats.defenceChance;
     }
 
     /**
-     * @brief Print Orc statistics with time of day indicator
+     * @brief Format Orc statistics with time of day indicator
      */
-    void printStats() override {
-        cout << "Orc " << name << " stats: "
-             << "Attack: " << getTotalAttack() << "Defence: " << getTotalDefence()
-             << "Health: " << getTotalHealth() << ", Strength: " << getTotalStrength()
-             << (isNight ? " [Night]" : " [Day]") << endl;
+    void formatStats(TextBuffer& out) const override {
+        out << "Orc " << name << " stats: "
+            << "Attack: " << getTotalAttack() << "Defence: " << getTotalDefence()
+            << "Health: " << getTotalHealth() << ", Strength: " << getTotalStrength()
+            << (isNight ? " [Night]" : " [Day]") << '\n';
     }
 
-    void successfulDef(Character* attacker, Character* defender);
+    /**
+     * @brief Orc's reaction to a successful defense (see Character::successfulDef())
+     *
+     * @param attacker Character that initiated the attack
+     * @param defender Orc character that successfully defended
+     */
+    static void defend(Character* attacker, Character* defender);
+};
+
+/// A race's reaction to a successful defense
+using DefenceHandler = void (*)(Character* attacker, Character* defender);
+
+/**
+ * @brief defend() handler of every race, indexed by RaceId
+ */
+inline constexpr DefenceHandler raceDefences[RACE_COUNT] = {
+    &Human::defend, &Elf::defend, &Dwarf::defend, &Hobbit::defend, &Orc::defend
 };
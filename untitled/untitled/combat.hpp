@@ -0,0 +1,185 @@
+/**
+ * @file combat.hpp
+ * @brief Combat instantiated per pair of races
+ *
+ * This file contains raceAttack(), the game's one combat rule, templated on
+ * the attacker's and defender's RaceTraits (races.hpp), so the hit and block
+ * chances are compile-time constants (an Elf never misses, so its miss
+ * branch is not even compiled), and on an output policy: QuietCombat for
+ * bulk simulation, ReportedCombat for the game's messages (attack() is
+ * fastAttack<ReportedCombat>). fastAttack() picks the instantiation for two
+ * characters from a table indexed by race (and time of day for Orcs)
+ * instead of looking anything up at run time.
+ *
+ * A character's chances must be its race's (every character's are, except
+ * an Orc's, which follow Orc::setTimeOfDay() and are matched by OrcDay and
+ * OrcNight). Both policies take the same random rolls, so a fight played
+ * either way ends the same.
+ *
+ * @author [Steffy Pereppadan Ignatious]
+ */
+#pragma once
+#include <iostream>
+#include "characters.hpp"
+#include "events.hpp"
+#include "random.hpp"
+
+using namespace std;
+
+/**
+ * @struct QuietCombat
+ * @brief Output policy that prints nothing
+ */
+struct QuietCombat {
+    static void attacks(const Character&, const Character&) {}
+    static void missed(const Character&) {}
+    static void damaged(const Character&, int) {}
+    static void blocked(const Character&) {}
+    static void defeated(const Character&) {}
+};
+
+/**
+ * @struct ReportedCombat
+ * @brief Output policy that prints the game's combat messages to gameOut()
+ */
+struct ReportedCombat {
+    static void attacks(const Character& attacker, const Character& defender) {
+        gameOut() << attacker.name << " attacks " << defender.name << endl;
+    }
+    static void missed(const Character& attacker) {
+        gameOut() << attacker.name << " missed!" << endl;
+    }
+    static void damaged(const Character& defender, int damage) {
+        gameOut() << defender.name << " takes " << damage << " hits of damage" << endl;
+        gameOut() << defender.name << " health: " << defender.getTotalHealth() << endl;
+    }
+    static void blocked(const Character& defender) {
+        gameOut() << defender.name << " blocked the attack" << endl;
+    }
+    static void defeated(const Character& defender) {
+        gameOut() << defender.name << " defeated" << endl;
+    }
+};
+
+/**
+ * @brief One attack between characters of known races
+ *
+ * Pseudo-code:
+ * 1. Report the attack
+ * 2. Generate random attack roll (0.0 to 1.0)
+ * 3. IF attack roll > AttackerRace's attack chance:
+ *    a. Report the miss
+ *    b. RETURN (attack failed)
+ * 4. Generate random defense roll (0.0 to 1.0)
+ * 5. IF defense roll < DefenderRace's defense chance:
+ *    a. Call DefenderRace's successful defence handler (race-specific)
+ *    b. RETURN (attack blocked)
+ * 6. Calculate damage = attacker total attack - defender total defense
+ * 7. IF damage > 0:
+ *    a. Subtract damage from defender health
+ *    b. IF health < 0: set health to 0
+ *    c. Report the damage
+ *    d. IF health > max health: set health to max health
+ * 8. ELSE: report the block
+ * 9. IF defender health <= 0: report the defeat
+ * Each outcome (and the damage and defeat) is also recorded in gameEvents().
+ *
+ * @tparam AttackerRace RaceTraits (or OrcNight) of the attacker
+ * @tparam DefenderRace RaceTraits (or OrcNight) of the defender
+ * @tparam Output QuietCombat or ReportedCombat
+ * @param attacker Character initiating the attack
+ * @param defender Character being attacked
+ */
+template <typename AttackerRace, typename DefenderRace, typename Output = QuietCombat>
+void raceAttack(Character& attacker, Character& defender) {
+    EventLog& events = gameEvents();
+    Output::attacks(attacker, defender);
+    float attackRoll = gameRandom().nextFloat();
+    if (attackRoll > AttackerRace::stats.attackChance) {
+        Output::missed(attacker);
+        events.record(EVENT_ATTACK, attacker.name, defender.name, ATTACK_MISSED);
+        return;
+    }
+    float defenceRoll = gameRandom().nextFloat();
+    if (defenceRoll < DefenderRace::stats.defenceChance) {
+        events.record(EVENT_ATTACK, attacker.name, defender.name, ATTACK_DEFENDED);
+        raceDefences[DefenderRace::id](&attacker, &defender);
+        return;
+    }
+
+    int totalAttack = attacker.getTotalAttack();
+    int totalDefence = defender.getTotalDefence();
+    if (totalAttack > totalDefence) {
+        int damage = totalAttack - totalDefence;
+        defender.health -= damage;
+        if (defender.health < 0) defender.health = 0;
+        Output::damaged(defender, damage);
+        events.record(EVENT_ATTACK, attacker.name, defender.name, ATTACK_HIT);
+        events.record(EVENT_DAMAGE, defender.name, InternedString(), damage, defender.getTotalHealth());
+        if (defender.health > defender.getTotalHealth()) {
+            defender.health = defender.getTotalHealth();
+        }
+    } else {
+        Output::blocked(defender);
+        events.record(EVENT_ATTACK, attacker.name, defender.name, ATTACK_BLOCKED);
+    }
+    if (defender.getTotalHealth() <= 0) {
+        Output::defeated(defender);
+        events.record(EVENT_DEFEAT, defender.name, attacker.name);
+    }
+}
+
+/// Rows and columns of the attack table: the races, then Orcs by night
+const int COMBAT_VARIANTS = RACE_COUNT + 1;
+
+/**
+ * @brief Row/column of a character in the attack table
+ */
+inline int combatVariant(const Character& character) {
+    if (character.raceId == RACE_ORC && static_cast<const Orc&>(character).isNight) return RACE_COUNT;
+    return character.raceId;
+}
+
+using RaceAttack = void (*)(Character&, Character&);  ///< One entry of the attack table
+
+/**
+ * @brief Attack table row of one attacking race
+ */
+template <typename Output, typename AttackerRace>
+struct RaceAttackRow {
+    static constexpr RaceAttack entries[COMBAT_VARIANTS] = {
+        &raceAttack<AttackerRace, HumanTraits, Output>,
+        &raceAttack<AttackerRace, ElfTraits, Output>,
+        &raceAttack<AttackerRace, DwarfTraits, Output>,
+        &raceAttack<AttackerRace, HobbitTraits, Output>,
+        &raceAttack<AttackerRace, OrcDay, Output>,
+        &raceAttack<AttackerRace, OrcNight, Output>,
+    };
+};
+
+/**
+ * @brief raceAttack() instantiation for every attacker and defender variant
+ */
+template <typename Output>
+struct RaceAttackTable {
+    static constexpr const RaceAttack* rows[COMBAT_VARIANTS] = {
+        RaceAttackRow<Output, HumanTraits>::entries,
+        RaceAttackRow<Output, ElfTraits>::entries,
+        RaceAttackRow<Output, DwarfTraits>::entries,
+        RaceAttackRow<Output, HobbitTraits>::entries,
+        RaceAttackRow<Output, OrcDay>::entries,
+        RaceAttackRow<Output, OrcNight>::entries,
+    };
+};
+
+/**
+ * @brief One attack through the instantiation for the two characters' races
+ *
+ * @tparam Output QuietCombat (default, for bulk simulation) or ReportedCombat
+ * @param attacker Character initiating the attack
+ * @param defender Character being attacked
+ */
+template <typename Output = QuietCombat>
+void fastAttack(Character& attacker, Character& defender) {
+    RaceAttackTable<Output>::rows[combatVariant(attacker)][combatVariant(defender)](attacker, defender);
+}
@@ -0,0 +1,116 @@
+/**
+ * @file counters.cpp
+ * @brief Counting operator new and the counter report
+ *
+ * @author [Ish Soundankar]
+ */
+#include "counters.hpp"
+#include <cstdlib>
+#include <new>
+#include <iomanip>
+
+TurnCounters turnCounters;
+
+#ifdef GAME_COUNTERS
+thread_local bool countedThread = false;
+
+/**
+ * @brief Count the allocations and shared_ptr copies of the calling thread (and no other)
+ */
+void countThisThread() {
+    countedThread = true;
+}
+
+/**
+ * @brief Make a phase the one allocations are counted against
+ *
+ * @param phase Phase being entered
+ * @return Phase that was current before (for leaveCountedPhase())
+ */
+int enterCountedPhase(int phase) {
+    int outer = turnCounters.current;
+    turnCounters.current = phase;
+    turnCounters.phases[phase].entries++;
+    return outer;
+}
+
+/**
+ * @brief Go back to the phase that was current before enterCountedPhase()
+ *
+ * @param outer Value enterCountedPhase() returned
+ */
+void leaveCountedPhase(int outer) {
+    turnCounters.current = outer;
+}
+
+/**
+ * @brief Counting replacement for the global operator new
+ *
+ * The array, nothrow and sized forms of new and delete all end up here or
+ * in free(), so every heap allocation made with new (including those of
+ * make_shared, vector and string) is counted. Allocations of other threads
+ * than the counted one are not, so the counts need no atomics.
+ */
+void* operator new(size_t size) {
+    if (countedThread && !turnCounters.paused) {
+        PhaseCounts& counts = turnCounters.phases[turnCounters.current];
+        counts.allocations++;
+        counts.bytes += size;
+    }
+    void* memory = malloc(size ? size : 1);
+    if (!memory) throw bad_alloc();
+    return memory;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    free(memory);
+}
+#endif
+
+/**
+ * @brief Print the counts of every phase that ran, in total and per entry
+ *
+ * Counting is paused while printing so the report does not count itself.
+ * The "other" row (work outside any phase, such as setting the game up)
+ * has no per-entry columns.
+ *
+ * @param out Stream to print to
+ */
+void TurnCounters::report(ostream& out) {
+    paused = true;
+    out << "Turn phase allocations and shared_ptr copies" << endl;
+    out << left << setw(10) << "phase" << right << setw(9) << "entries" << setw(12) << "allocs"
+        << setw(12) << "bytes" << setw(12) << "sp copies" << setw(12) << "allocs/e"
+        << setw(12) << "sp/e" << endl;
+    out << fixed << setprecision(2);
+    for (int phase = 0; phase <= OUTSIDE; phase++) {
+        const PhaseCounts& c = phases[phase];
+        if (c.entries == 0 && c.allocations == 0 && c.sharedCopies == 0) continue;
+        out << left << setw(10) << phaseName(phase) << right << setw(9) << c.entries
+            << setw(12) << c.allocations << setw(12) << c.bytes << setw(12) << c.sharedCopies;
+        if (c.entries > 0) {
+            out << setw(12) << (double)c.allocations / c.entries
+                << setw(12) << (double)c.sharedCopies / c.entries;
+        }
+        out << endl;
+    }
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+    paused = false;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file counters.hpp
+ * @brief Heap allocation and shared_ptr copy counts per turn phase
+ *
+ * This file contains the TurnCounters table used by the counter build
+ * (GAME_COUNTERS, qmake CONFIG+=counters). In that build the global
+ * operator new is replaced by one that counts every allocation and its size
+ * against the phase marked by the innermost TIME_PHASE, and the places where
+ * the turn loop copies a shared_ptr (by-value parameters, square and
+ * equipment assignments) add to the phase's copy count with
+ * COUNT_SHARED_COPY. In other builds COUNT_SHARED_COPY expands to nothing.
+ *
+ * Only the game thread counts (main() marks it with countThisThread()):
+ * the event writer and the threads of Board::generate() allocate too, and
+ * would otherwise race on the counts and land in whatever phase the game
+ * thread is in.
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include "timing.hpp"
+
+using namespace std;
+
+/**
+ * @struct PhaseCounts
+ * @brief What happened while one phase was current
+ */
+struct PhaseCounts {
+    uint64_t entries = 0;       ///< Times the phase was entered
+    uint64_t allocations = 0;   ///< operator new calls
+    uint64_t bytes = 0;         ///< Bytes requested from operator new
+    uint64_t sharedCopies = 0;  ///< shared_ptr copies at the counted places
+};
+
+/**
+ * @class TurnCounters
+ * @brief Counts for every phase, plus one slot for outside any phase
+ *
+ * Plain data with constant initial values, so it is usable by operator new
+ * before main() starts.
+ */
+class TurnCounters {
+public:
+    static const int OUTSIDE = PHASE_COUNT;  ///< Slot for work outside any phase
+
+    PhaseCounts phases[PHASE_COUNT + 1];  ///< Counts of each phase (and OUTSIDE)
+    int current = OUTSIDE;                ///< Phase allocations are counted against
+    bool paused = false;                  ///< Set while printing the report
+
+    /**
+     * @brief Print the counts of every phase that ran, in total and per entry
+     *
+     * @param out Stream to print to
+     */
+    void report(ostream& out);
+};
+
+extern TurnCounters turnCounters;  ///< The game's counters (counter builds only)
+
+#ifdef GAME_COUNTERS
+extern thread_local bool countedThread;  ///< Set on the one thread whose work is counted
+
+/**
+ * @brief Count the allocations and shared_ptr copies of the calling thread (and no other)
+ */
+void countThisThread();
+
+/// Count n shared_ptr copies against the current phase (on the counted thread)
+#define COUNT_SHARED_COPY(n) \
+    (countedThread ? (void)(turnCounters.phases[turnCounters.current].sharedCopies += (n)) : (void)0)
+#else
+#define COUNT_SHARED_COPY(n) ((void)0)
+#endif
@@ -0,0 +1,310 @@
+/**
+ * @file events.cpp
+ * @brief Encoding events as JSON Lines or binary records, synchronously or on a writer thread
+ *
+ * @author [Ish Soundankar]
+ */
+#include "events.hpp"
+#include <chrono>
+
+/**
+ * @enum ValueStyle
+ * @brief How a JSON value field is written
+ */
+enum ValueStyle {
+    VALUE_NUMBER,   ///< As a number
+    VALUE_BOOL,     ///< true / false
+    VALUE_OUTCOME   ///< Name of an AttackOutcome
+};
+
+/**
+ * @struct EventKind
+ * @brief JSON name and keys of one event type (nullptr: field not written)
+ */
+struct EventKind {
+    const char* name;     ///< "event" value
+    const char* subject;  ///< Key of the subject name
+    const char* object;   ///< Key of the object name
+    const char* value;    ///< Key of value
+    ValueStyle style;     ///< How value is written
+    const char* extra;    ///< Key of extra
+};
+
+static const EventKind eventKinds[EVENT_TYPES] = {
+    {"move", "player", nullptr, nullptr, VALUE_NUMBER, nullptr},
+    {"encounter", "enemy", "race", nullptr, VALUE_NUMBER, nullptr},
+    {"find", "item", nullptr, nullptr, VALUE_NUMBER, nullptr},
+    {"pickup", "item", nullptr, "picked_up", VALUE_BOOL, nullptr},
+    {"attack", "attacker", "defender", "outcome", VALUE_OUTCOME, nullptr},
+    {"damage", "character", nullptr, "damage", VALUE_NUMBER, "health"},
+    {"defeat", "character", "by", nullptr, VALUE_NUMBER, nullptr},
+    {"time_of_day", nullptr, nullptr, "night", VALUE_BOOL, nullptr},
+};
+
+static const char* const outcomeNames[ATTACK_OUTCOMES] = {"missed", "defended", "hit", "blocked"};
+
+// Events the writer thread encodes before looking at the ring again
+const size_t EVENT_WRITER_BATCH = 256;
+
+/**
+ * @brief Name of an event type as written in JSON ("move", "damage", ...)
+ */
+const char* eventName(EventType type) {
+    return type < EVENT_TYPES ? eventKinds[type].name : "unknown";
+}
+
+/**
+ * @brief Write a string as a JSON string literal
+ *
+ * Pseudo-code:
+ * 1. Write the opening quote
+ * 2. FOR each character: escape quotes, backslashes and control
+ *    characters, copy the rest
+ * 3. Write the closing quote
+ */
+static void putJsonString(TextBuffer& out, string_view text) {
+    static const char* const hex = "0123456789abcdef";
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if ((unsigned char)c < 0x20) {
+            out << "\\u00" << hex[(unsigned char)c >> 4] << hex[c & 15];
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+/**
+ * @brief Write one event as a line of JSON
+ */
+static void putJsonEvent(TextBuffer& out, const GameEvent& event, const string& subject, const string& object) {
+    const EventKind& kind = eventKinds[event.type < EVENT_TYPES ? event.type : (uint8_t)EVENT_MOVE];
+    out << "{\"turn\":" << event.turn << ",\"event\":\"" << kind.name
+        << "\",\"row\":" << event.row << ",\"column\":" << event.column;
+    if (kind.subject) {
+        out << ",\"" << kind.subject << "\":";
+        putJsonString(out, subject);
+    }
+    if (kind.object) {
+        out << ",\"" << kind.object << "\":";
+        putJsonString(out, object);
+    }
+    if (kind.value) {
+        out << ",\"" << kind.value << "\":";
+        if (kind.style == VALUE_BOOL) {
+            out << (event.value ? "true" : "false");
+        } else if (kind.style == VALUE_OUTCOME && event.value >= 0 && event.value < ATTACK_OUTCOMES) {
+            out << '"' << outcomeNames[event.value] << '"';
+        } else {
+            out << event.value;
+        }
+    }
+    if (kind.extra) {
+        out << ",\"" << kind.extra << "\":" << event.extra;
+    }
+    out << "}\n";
+}
+
+/**
+ * @brief Append the raw bytes of a trivially copyable value
+ */
+template <typename T>
+static void putRaw(TextBuffer& out, const T& value) {
+    out << string_view((const char*)&value, sizeof(T));
+}
+
+/**
+ * @brief Constructor, writes the binary file header if binary
+ *
+ * @param stream Stream to write to (binary mode for EVENTS_BINARY)
+ * @param eventFormat Format to write in
+ */
+EventEncoder::EventEncoder(ostream& stream, EventFormat eventFormat)
+    : format(eventFormat), memory(EVENT_BLOCK_SIZE), text(memory.data(), memory.size(), stream) {
+    if (format == EVENTS_BINARY) {
+        EventFileHeader header = {{'A', 'P', 'G', 'E'}, EVENTS_VERSION};
+        putRaw(text, header);
+    }
+}
+
+/**
+ * @brief Give the text of a name id (which must stay valid and unchanged)
+ *
+ * A binary stream gets an 'S' record defining the name.
+ *
+ * @param id Name id
+ * @param name Its text
+ */
+void EventEncoder::defineName(uint32_t id, const string& name) {
+    if (id >= names.size()) names.resize(id + 1);
+    names[id] = &name;
+    if (format == EVENTS_BINARY) {
+        uint16_t length = (uint16_t)name.size();
+        text << 'S';
+        putRaw(text, id);
+        putRaw(text, length);
+        text << string_view(name.data(), length);
+    }
+}
+
+/**
+ * @brief Add one event to the block (its names must have been defined)
+ *
+ * JSON Lines get the event as one line, binary streams an 'E' record. The
+ * block is written to the stream whenever it fills up.
+ *
+ * @param event Event to add
+ */
+void EventEncoder::add(const GameEvent& event) {
+    if (format == EVENTS_JSONL) {
+        putJsonEvent(text, event, *names[event.subject], *names[event.object]);
+        return;
+    }
+    text << 'E';
+    putRaw(text, event);
+}
+
+/**
+ * @brief Constructor, starts the thread
+ *
+ * @param stream Stream to write to; only the writer thread uses it until destruction
+ * @param eventFormat Format to write in
+ * @param capacity Events the ring holds
+ */
+EventWriterThread::EventWriterThread(ostream& stream, EventFormat eventFormat, size_t capacity)
+    : queue(capacity), encoder(stream, eventFormat), worker(&EventWriterThread::run, this) {}
+
+/**
+ * @brief Destructor, writes every queued event and stops the thread
+ */
+EventWriterThread::~EventWriterThread() {
+    stopping.store(true, memory_order_release);
+    worker.join();
+}
+
+/**
+ * @brief Body of the writer thread
+ *
+ * Pseudo-code:
+ * 1. LOOP:
+ *    a. Note whether stopping was asked for
+ *    b. Encode up to EVENT_WRITER_BATCH queued events (defining the names
+ *       sent with them first)
+ *    c. IF there were none:
+ *       - IF stopping was asked for before looking: STOP (everything
+ *         pushed before that has been taken)
+ *       - Write the partial block out and sleep EVENT_WRITER_IDLE_US
+ * 2. Write the rest of the block out
+ */
+void EventWriterThread::run() {
+    while (true) {
+        bool stop = stopping.load(memory_order_acquire);
+        size_t taken = queue.popMany(EVENT_WRITER_BATCH, [&](const QueuedEvent& queued) {
+            if (queued.subject) encoder.defineName(queued.event.subject, *queued.subject);
+            if (queued.object) encoder.defineName(queued.event.object, *queued.object);
+            encoder.add(queued.event);
+        });
+        if (taken == 0) {
+            if (stop) break;
+            encoder.flush();
+            this_thread::sleep_for(chrono::microseconds(EVENT_WRITER_IDLE_US));
+        }
+    }
+    encoder.flush();
+}
+
+/**
+ * @brief Drop all events and change the ring's capacity
+ *
+ * @param capacity Events the ring holds (rounded up to a power of two)
+ */
+void EventLog::resize(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+    ring.assign(size, GameEvent());
+    head = 0;
+    count = 0;
+}
+
+/**
+ * @brief Start recording, writing to a stream
+ *
+ * Pseudo-code:
+ * 1. Close the stream already open, if any
+ * 2. IF async: start a writer thread with a queue as large as the ring
+ *    ELSE: create an encoder for the ring to be written with
+ * 3. Enable recording
+ *
+ * @param stream Stream to write to (binary mode for EVENTS_BINARY)
+ * @param eventFormat Format to write in
+ * @param async Write from an EventWriterThread instead of the recording thread
+ */
+void EventLog::open(ostream& stream, EventFormat eventFormat, bool async) {
+    if (out) close();
+    out = &stream;
+    if (async) {
+        writer = make_unique<EventWriterThread>(stream, eventFormat, ring.size());
+    } else {
+        encoder = make_unique<EventEncoder>(stream, eventFormat);
+    }
+    enabled = true;
+}
+
+/**
+ * @brief Start recording, writing to a file
+ *
+ * @param path File to create
+ * @param eventFormat Format to write in
+ * @param async Write from an EventWriterThread instead of the recording thread
+ * @return false if the file could not be created
+ */
+bool EventLog::openFile(const string& path, EventFormat eventFormat, bool async) {
+    close();
+    file.open(path, ios::binary | ios::trunc);
+    if (!file) return false;
+    open(file, eventFormat, async);
+    return true;
+}
+
+/**
+ * @brief Write out and stop recording, closing the file if openFile() opened it
+ *
+ * Stopping the writer thread waits for it to write everything queued.
+ */
+void EventLog::close() {
+    writer.reset();
+    if (encoder) {
+        flush();
+        encoder.reset();
+    }
+    if (out) out->flush();
+    if (file.is_open()) file.close();
+    out = nullptr;
+    enabled = false;
+}
+
+/**
+ * @brief Write the events in the ring to the stream and empty it
+ *
+ * Pseudo-code:
+ * 1. IF there is no encoder: RETURN (the ring keeps its events)
+ * 2. Encode every event in the ring, oldest first, defining its names
+ *    with the encoder the first time they are used
+ * 3. Write the block out and empty the ring
+ */
+void EventLog::flush() {
+    if (!encoder) return;
+    StringTable& table = stringTable();
+    for (size_t i = 0; i < count; i++) {
+        const GameEvent& event = (*this)[i];
+        if (!encoder->knows(event.subject)) encoder->defineName(event.subject, table.text(event.subject));
+        if (!encoder->knows(event.object)) encoder->defineName(event.object, table.text(event.object));
+        encoder->add(event);
+    }
+    encoder->flush();
+    head = 0;
+    count = 0;
+}
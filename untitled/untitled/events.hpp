@@ -0,0 +1,370 @@
+/**
+ * @file events.hpp
+ * @brief Typed gameplay events, buffered and written as JSON Lines or binary
+ *
+ * This file contains GameEvent, a fixed-size record of one thing that
+ * happened in a turn (a move, an encounter, an item found or picked up, an
+ * attack and its damage, a defeat, the time of day changing), and EventLog,
+ * a ring buffer of them that is written to a stream in one of two formats
+ * when it fills up or is flushed. Recording is off until a log is opened,
+ * and then costs a few stores per event: names are kept as InternedString
+ * ids and only turned into text when the ring is written. Opened with
+ * async, the formatting and writing happen on a background thread fed by
+ * a lock-free ring (EventWriterThread), off the game thread altogether.
+ *
+ * JSON Lines (EVENTS_JSONL): one object per event, for example
+ *   {"turn":12,"event":"damage","row":3,"column":4,"subject":"Bob","damage":5,"health":95}
+ * with the keys of each type listed in eventKinds (events.cpp).
+ *
+ * Binary (EVENTS_BINARY), native byte order like the other save files:
+ * 1. EventFileHeader (magic "APGE", version)
+ * 2. Records, each a u8 tag followed by
+ *    - 'S': u32 id and a u16-length string, the first time a name id is used
+ *    - 'E': a GameEvent (sizeof(GameEvent) bytes)
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <cstdint>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "interned.hpp"
+#include "position.hpp"
+#include "spscring.hpp"
+#include "textbuffer.hpp"
+
+using namespace std;
+
+/**
+ * @enum EventType
+ * @brief What a GameEvent records
+ */
+enum EventType : uint8_t {
+    EVENT_MOVE,         ///< subject (the player) moved to (row, column)
+    EVENT_ENCOUNTER,    ///< Player moved onto enemy subject, of race object
+    EVENT_FIND,         ///< Player moved onto item subject
+    EVENT_PICKUP,       ///< Player tried to pick up item subject: value = 1 if picked up
+    EVENT_ATTACK,       ///< subject attacked object: value = AttackOutcome
+    EVENT_DAMAGE,       ///< subject took value damage, extra = its total health after
+    EVENT_DEFEAT,       ///< subject was defeated by object
+    EVENT_TIME_OF_DAY,  ///< value = 1 for night, 0 for day
+    EVENT_TYPES
+};
+
+/**
+ * @enum AttackOutcome
+ * @brief Value of an EVENT_ATTACK
+ */
+enum AttackOutcome : int32_t {
+    ATTACK_MISSED,    ///< Attack roll failed
+    ATTACK_DEFENDED,  ///< Defence roll succeeded (the defender's race handler ran)
+    ATTACK_HIT,       ///< Damage was dealt (an EVENT_DAMAGE follows)
+    ATTACK_BLOCKED,   ///< Attack did not beat the defender's total defence
+    ATTACK_OUTCOMES
+};
+
+/**
+ * @struct GameEvent
+ * @brief One gameplay event (32 bytes)
+ *
+ * row and column are the player's position when the event happened;
+ * subject and object are name ids in stringTable() (0 = none).
+ */
+struct GameEvent {
+    int32_t turn;        ///< Turn the event happened in
+    uint8_t type;        ///< EventType
+    uint8_t unused[3];   ///< Padding, always 0
+    int32_t row;         ///< Player's row
+    int32_t column;      ///< Player's column
+    uint32_t subject;    ///< Name id of who the event is about
+    uint32_t object;     ///< Name id of the other party (defender, attacker, race)
+    int32_t value;       ///< Type-specific value (see EventType)
+    int32_t extra;       ///< Second type-specific value
+};
+
+/**
+ * @enum EventFormat
+ * @brief How an EventLog writes its events
+ */
+enum EventFormat {
+    EVENTS_JSONL,   ///< One JSON object per line
+    EVENTS_BINARY   ///< Tagged binary records
+};
+
+/**
+ * @struct EventFileHeader
+ * @brief Start of a binary event file
+ */
+struct EventFileHeader {
+    char magic[4];     ///< "APGE"
+    uint32_t version;  ///< EVENTS_VERSION of the writer
+};
+
+// Bump whenever GameEvent or the meaning of its fields changes
+const uint32_t EVENTS_VERSION = 1;
+
+// Bytes an EventEncoder collects before writing them to its stream
+const size_t EVENT_BLOCK_SIZE = 1 << 16;
+
+/**
+ * @class EventEncoder
+ * @brief Turns events into the bytes of one format and writes them in blocks
+ *
+ * Keeps the state a stream needs across blocks: the text of every name id
+ * seen so far, given once with defineName() before the first event that
+ * uses it (a binary stream gets an 'S' record for it at that point). It
+ * never looks at the string table itself, so it can run on another thread.
+ */
+class EventEncoder {
+public:
+    EventFormat format;           ///< Format written
+    vector<char> memory;          ///< Block being filled
+    TextBuffer text;              ///< Formats into memory, writes it to the stream when full
+    vector<const string*> names;  ///< Text of each name id defined so far (nullptr: not yet)
+
+    /**
+     * @brief Constructor, writes the binary file header if binary
+     *
+     * @param stream Stream to write to (binary mode for EVENTS_BINARY)
+     * @param eventFormat Format to write in
+     */
+    EventEncoder(ostream& stream, EventFormat eventFormat);
+    EventEncoder(const EventEncoder&) = delete;
+    EventEncoder& operator=(const EventEncoder&) = delete;
+
+    /**
+     * @brief Whether a name id has been defined
+     */
+    bool knows(uint32_t id) const { return id < names.size() && names[id]; }
+
+    /**
+     * @brief Give the text of a name id (which must stay valid and unchanged)
+     */
+    void defineName(uint32_t id, const string& name);
+
+    /**
+     * @brief Add one event to the block (its names must have been defined)
+     */
+    void add(const GameEvent& event);
+
+    /**
+     * @brief Write what is in the block to the stream
+     */
+    void flush() { text.flush(); }
+};
+
+/**
+ * @struct QueuedEvent
+ * @brief An event on its way to the writer thread, with any new names resolved
+ *
+ * The string table is only read on the game thread; the strings it hands
+ * out never move or change, so the writer thread can read them by pointer.
+ * Each name is sent once, with the first event that uses it.
+ */
+struct QueuedEvent {
+    GameEvent event;        ///< The event
+    const string* subject;  ///< Text of event.subject if it is new, otherwise nullptr
+    const string* object;   ///< Text of event.object if it is new, otherwise nullptr
+};
+
+// How long the writer thread sleeps when it finds no events
+const int EVENT_WRITER_IDLE_US = 200;
+
+/**
+ * @class EventWriterThread
+ * @brief Background thread that formats and writes events queued by the game thread
+ *
+ * The game thread push()es into a lock-free SpscRing and goes on with the
+ * turn; the writer thread takes events off in batches, encodes them and
+ * writes them, so a slow stream slows the writer, not the game. The game
+ * thread only waits if the ring is full (the stream has fallen a whole
+ * ring behind). When the ring runs dry the writer writes its partial block
+ * out and sleeps EVENT_WRITER_IDLE_US.
+ */
+class EventWriterThread {
+public:
+    SpscRing<QueuedEvent> queue;      ///< Events from the game thread
+    EventEncoder encoder;             ///< Used by the writer thread only
+    atomic<bool> stopping{false};     ///< Set by the destructor: drain and stop
+    uint64_t fullWaits = 0;           ///< Pushes that found the ring full (game thread)
+    vector<bool> namesSent;           ///< Name ids already sent (game thread)
+    thread worker;                    ///< The writer thread (started last)
+
+    /**
+     * @brief Constructor, starts the thread
+     *
+     * @param stream Stream to write to; only the writer thread uses it until destruction
+     * @param eventFormat Format to write in
+     * @param capacity Events the ring holds
+     */
+    EventWriterThread(ostream& stream, EventFormat eventFormat, size_t capacity);
+    EventWriterThread(const EventWriterThread&) = delete;
+    EventWriterThread& operator=(const EventWriterThread&) = delete;
+
+    /**
+     * @brief Destructor, writes every queued event and stops the thread
+     */
+    ~EventWriterThread();
+
+    /**
+     * @brief Queue an event (game thread), waiting only if the ring is full
+     */
+    void push(const GameEvent& event) {
+        QueuedEvent queued = {event, newName(event.subject), newName(event.object)};
+        while (!queue.tryPush(queued)) {
+            fullWaits++;
+            this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Text of a name id the first time it is queued, otherwise nullptr (game thread)
+     */
+    const string* newName(uint32_t id) {
+        if (id < namesSent.size() && namesSent[id]) return nullptr;
+        if (id >= namesSent.size()) namesSent.resize(id + 1);
+        namesSent[id] = true;
+        return &stringTable().text(id);
+    }
+
+    /**
+     * @brief Body of the writer thread
+     */
+    void run();
+};
+
+/**
+ * @class EventLog
+ * @brief Ring buffer of events, written out when full or flushed
+ *
+ * Without a stream the ring keeps the most recent events, overwriting the
+ * oldest. With one, a full ring is written out and emptied instead, so no
+ * event is lost and the stream is written in large blocks. Opened
+ * asynchronously, events skip the ring and go to an EventWriterThread
+ * instead, which writes them while the game carries on.
+ */
+class EventLog {
+public:
+    bool enabled = false;        ///< Whether record() stores anything
+    vector<GameEvent> ring;      ///< Events (size is a power of two)
+    size_t head = 0;             ///< Index of the oldest event
+    size_t count = 0;            ///< Events in the ring
+    int turn = 0;                ///< Turn stamped on new events
+    Position at = {0, 0};        ///< Player position stamped on new events
+    ostream* out = nullptr;      ///< Where events are written (nullptr: kept in the ring)
+    ofstream file;               ///< Stream opened by openFile()
+    unique_ptr<EventEncoder> encoder;       ///< Writes the ring to out (synchronous)
+    unique_ptr<EventWriterThread> writer;   ///< Writes events to out (asynchronous)
+
+    /**
+     * @brief Constructor
+     *
+     * @param capacity Events the ring holds (rounded up to a power of two)
+     */
+    EventLog(size_t capacity = 4096) { resize(capacity); }
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+    ~EventLog() { close(); }
+
+    /**
+     * @brief Drop all events and change the ring's capacity
+     */
+    void resize(size_t capacity);
+
+    /**
+     * @brief Start recording, writing to a stream
+     *
+     * @param stream Stream to write to (binary mode for EVENTS_BINARY)
+     * @param eventFormat Format to write in
+     * @param async Write from an EventWriterThread instead of the recording thread
+     */
+    void open(ostream& stream, EventFormat eventFormat, bool async = false);
+
+    /**
+     * @brief Start recording, writing to a file
+     *
+     * @param path File to create
+     * @param eventFormat Format to write in
+     * @param async Write from an EventWriterThread instead of the recording thread
+     * @return false if the file could not be created
+     */
+    bool openFile(const string& path, EventFormat eventFormat, bool async = false);
+
+    /**
+     * @brief Write out and stop recording, closing the file if openFile() opened it
+     */
+    void close();
+
+    /**
+     * @brief Set the turn and player position stamped on the next events
+     */
+    void beginTurn(int turnNumber, Position player) {
+        turn = turnNumber;
+        at = player;
+    }
+
+    /**
+     * @brief Record an event (nothing unless the log is enabled)
+     *
+     * @param type What happened
+     * @param subject Who it happened to
+     * @param object The other party
+     * @param value Type-specific value
+     * @param extra Second type-specific value
+     */
+    void record(EventType type, InternedString subject = InternedString(),
+                InternedString object = InternedString(), int value = 0, int extra = 0) {
+        if (!enabled) return;
+        GameEvent event = GameEvent();
+        event.turn = turn;
+        event.type = type;
+        event.row = at.row;
+        event.column = at.column;
+        event.subject = subject.id;
+        event.object = object.id;
+        event.value = value;
+        event.extra = extra;
+        if (writer) {
+            writer->push(event);
+            return;
+        }
+        if (count == ring.size()) {
+            if (encoder) {
+                flush();
+            } else {
+                head = (head + 1) & (ring.size() - 1);
+                count--;
+            }
+        }
+        ring[(head + count) & (ring.size() - 1)] = event;
+        count++;
+    }
+
+    /**
+     * @brief Event i of the ring, oldest first
+     */
+    const GameEvent& operator[](size_t i) const { return ring[(head + i) & (ring.size() - 1)]; }
+
+    /**
+     * @brief Write the events in the ring to the stream and empty it
+     */
+    void flush();
+};
+
+/**
+ * @brief Name of an event type as written in JSON ("move", "damage", ...)
+ */
+const char* eventName(EventType type);
+
+/**
+ * @brief The log the game records its events into (disabled until opened)
+ */
+inline EventLog& gameEvents() {
+    static EventLog log;
+    return log;
+}
@@ -0,0 +1,497 @@
+/**
+ * @file game.cpp
+ * @brief Combat and turn processing for a game session
+ *
+ * @author [Ish Soundankar]
+ */
+#include "game.hpp"
+#include "random.hpp"
+#include "ItemsDB.h"
+#include "timing.hpp"
+#include "counters.hpp"
+#include "events.hpp"
+#include "combat.hpp"
+
+/**
+ * @brief Read one character answer and remember it
+ *
+ * @param c Set to the character read
+ * @return false if the stream had no more input
+ */
+bool TurnInput::readChar(char& c) {
+    if (!(in >> c)) return false;
+    record += c;
+    record += ' ';
+    return true;
+}
+
+/**
+ * @brief Read a number answer and remember it
+ *
+ * A failed read is remembered as "?", which fails the same way when the
+ * answer is read back from the journal.
+ *
+ * @param value Set to the number read
+ * @return false if the answer was not a number
+ */
+bool TurnInput::readInt(int& value) {
+    if (in >> value) {
+        record += to_string(value);
+        record += ' ';
+        return true;
+    }
+    record += "? ";
+    return false;
+}
+
+/**
+ * @brief Throw away the rest of the current input line after a bad answer
+ *
+ * Only input that has already arrived is dropped, so with single-key
+ * input this never waits for the player to press Enter.
+ */
+void TurnInput::discardLine() {
+    in.clear();
+    while (in.rdbuf()->in_avail() > 0) {
+        if (in.get() == '\n') break;
+    }
+}
+
+/**
+ * @brief Create a player of a race chosen from the race menu
+ *
+ * @param race 1 = Human, 2 = Elf, 3 = Dwarf, 4 = Hobbit, 5 = Orc
+ * @param name Player's name
+ * @return New character, or nullptr for any other number
+ */
+shared_ptr<Character> makePlayer(int race, const string& name) {
+    switch (race) {
+    case 1: return make_shared<Human>(name);
+    case 2: return make_shared<Elf>(name);
+    case 3: return make_shared<Dwarf>(name);
+    case 4: return make_shared<Hobbit>(name);
+    case 5: return make_shared<Orc>(name);
+    default: return nullptr;
+    }
+}
+
+/**
+ * @brief Set a session up for a new game
+ *
+ * Pseudo-code:
+ * 1. Reset the session
+ * 2. IF endless: create an endless board from the world seed
+ *    ELSE IF generated: create a bounded board and generate all of it from
+ *    the world seed
+ *    ELSE: create a bounded board and place the standard enemies and items
+ * 3. Create the player
+ * 4. IF standard bounded: size the buffers turns reuse (path search, route,
+ *    the player's inventory) for the whole board, so no turn has to grow them
+ *
+ * @param session Session to replace
+ * @param setup Start-up answers
+ */
+void newGame(GameSession& session, const GameSetup& setup) {
+    session = GameSession();
+    size_t itemCount = 0;
+    if (setup.endless) {
+        session.board = make_unique<Board>(setup.worldSeed);
+    } else if (setup.generated) {
+        session.board = make_unique<Board>(setup.length, setup.breadth);
+        session.board->generate(setup.worldSeed);
+    } else {
+        vector<shared_ptr<Character>> enemies;
+        enemies.push_back(make_shared<Human>("Bob"));
+        enemies.push_back(make_shared<Elf>("Legolas"));
+        enemies.push_back(make_shared<Dwarf>("Gimli"));
+        enemies.push_back(make_shared<Hobbit>("Frodo"));
+        enemies.push_back(make_shared<Orc>("Azog"));
+
+        vector<shared_ptr<Item>> items;
+        items.push_back(Sword);
+        items.push_back(Dagger);
+        items.push_back(LeatherArmor);
+        items.push_back(PlateArmor);
+        items.push_back(RingOfLife);
+        items.push_back(RingOfStrength);
+        itemCount = items.size();
+
+        session.board = make_unique<Board>(setup.length, setup.breadth);
+        session.board->populateBoard(enemies, items);
+    }
+    session.player = makePlayer(setup.race, setup.name);
+
+    if (!setup.endless && !setup.generated) {
+        // A route visits a square at most once, and only the items placed
+        // above can ever be picked up
+        size_t squares = (size_t)setup.length * setup.breadth;
+        session.board->pathOpen.reserve(squares);
+        session.route.reserve(squares);
+        if (session.player) {
+            session.player->inventory.reserve(itemCount);
+            session.player->ring.reserve(itemCount);
+        }
+    }
+}
+
+/**
+ * @brief Hash of the session's counters, player and random state
+ *
+ * FNV-1a over the turn counters, position, gold, time of day, the player's
+ * stats and equipment counts and the random generator state. Board contents
+ * are left out: an endless board generates chunks as they are looked at, so
+ * its entity counts depend on what was printed, not only on the turns.
+ *
+ * @param session Session to hash
+ * @return 64-bit digest
+ */
+uint64_t sessionDigest(const GameSession& session) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&](uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= (value >> (i * 8)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+    const Character& player = *session.player;
+    mix((uint64_t)session.turn);
+    mix((uint64_t)session.commandCount);
+    mix((uint64_t)session.playerRow);
+    mix((uint64_t)session.playerColumn);
+    mix((uint64_t)session.gold);
+    mix(session.isNight ? 1 : 0);
+    mix((uint64_t)player.health);
+    mix((uint64_t)player.attack);
+    mix((uint64_t)player.defence);
+    mix((uint64_t)player.strength);
+    mix(player.inventory.size());
+    mix(player.ring.size());
+    mix(gameRandom().state);
+    return hash;
+}
+
+/**
+ * @brief Handle combat between two characters
+ *
+ * Played by the raceAttack() instantiation for the two characters' races
+ * (see fastAttack()), with its messages printed to gameOut().
+ *
+ * @param attacker Character initiating the attack
+ * @param defender Character being attacked
+ */
+void attack(Character* attacker, Character* defender) {
+    fastAttack<ReportedCombat>(*attacker, *defender);
+}
+
+/**
+ * @brief Apply one command to the session
+ *
+ * Pseudo-code:
+ * 1. Count the turn and remove player from current square
+ * 2. SWITCH on command:
+ *    - Movement (w/a/s/d): Update position unless the edge or a wall is in
+ *      the way, check square content
+ *    - Pickup (g): Attempt to pick up item
+ *    - Attack (j): Combat with enemy on square
+ *    - Drop (h): Drop equipped item (slot and ring read from input)
+ *    - Look (k): Display square information
+ *    - Inventory (l): Display player inventory
+ *    - Nearest (n): Display closest enemy and item and how far away they are
+ *    - Fog (f): Toggle fog of war on the printed board
+ *    - Exit (x): Set gameOver = true
+ * 3. Update day/night cycle if needed
+ * 4. Place player on new square and update what the player can see
+ * Moves, encounters, items found and picked up and changes of the time of
+ * day are recorded in gameEvents() along the way.
+ *
+ * @param session Session to update
+ * @param choice Command character
+ * @param input Where follow-up answers are read from
+ */
+void playTurn(GameSession& session, char choice, TurnInput& input) {
+    TIME_PHASE(PHASE_LOGIC);
+    Board& board = *session.board;
+    ostream& out = gameOut();
+    EventLog& events = gameEvents();
+    session.turn++;
+    events.beginTurn(session.turn, {session.playerRow, session.playerColumn});
+
+    board.at(session.playerRow, session.playerColumn).player = nullptr;
+
+    switch (choice) {
+    case 'w':
+        out << "moving up" << endl;
+        if (session.playerRow > 0 && !board.isWall(session.playerRow - 1, session.playerColumn)) {
+            session.playerRow--;
+            events.at = {session.playerRow, session.playerColumn};
+            events.record(EVENT_MOVE, session.player->name);
+            Square& currentSquare = board.at(session.playerRow, session.playerColumn);
+            if (currentSquare.enemy) {
+                out << "\n*** You've encountered an enemy! ***" << endl;
+                currentSquare.enemy->printStats();
+                events.record(EVENT_ENCOUNTER, currentSquare.enemy->name, currentSquare.enemy->race);
+            }
+            if (currentSquare.item) {
+                out << "\n*** You've found an item! ***" << endl;
+                currentSquare.item->print();
+                events.record(EVENT_FIND, currentSquare.item->name);
+            }
+        } else if (session.playerRow > 0) {
+            out << "Cannot move up! There's a wall in the way." << endl;
+        } else {
+            out << "Cannot move up! You're at the top edge of the board." << endl;
+        }
+        session.commandCount++;
+        break;
+
+    case 's':
+        out << "moving down" << endl;
+        if (session.playerRow < board.height - 1 && !board.isWall(session.playerRow + 1, session.playerColumn)) {
+            session.playerRow++;
+            events.at = {session.playerRow, session.playerColumn};
+            events.record(EVENT_MOVE, session.player->name);
+            Square& currentSquare = board.at(session.playerRow, session.playerColumn);
+            if (currentSquare.enemy) {
+                out << "\n*** You've encountered an enemy! ***" << endl;
+                currentSquare.enemy->printStats();
+                events.record(EVENT_ENCOUNTER, currentSquare.enemy->name, currentSquare.enemy->race);
+            }
+            if (currentSquare.item) {
+                out << "\n*** You've found an item! ***" << endl;
+                currentSquare.item->print();
+                events.record(EVENT_FIND, currentSquare.item->name);
+            }
+        } else if (session.playerRow < board.height - 1) {
+            out << "Cannot move down! There's a wall in the way." << endl;
+        } else {
+            out << "Cannot move down! You're at the bottom edge of the board." << endl;
+        }
+        session.commandCount++;
+        break;
+
+    case 'a':
+        out << "moving left" << endl;
+        if (session.playerColumn > 0 && !board.isWall(session.playerRow, session.playerColumn - 1)) {
+            session.playerColumn--;
+            events.at = {session.playerRow, session.playerColumn};
+            events.record(EVENT_MOVE, session.player->name);
+            Square& currentSquare = board.at(session.playerRow, session.playerColumn);
+            if (currentSquare.enemy) {
+                out << "\n*** You've encountered an enemy! ***" << endl;
+                currentSquare.enemy->printStats();
+                events.record(EVENT_ENCOUNTER, currentSquare.enemy->name, currentSquare.enemy->race);
+            }
+            if (currentSquare.item) {
+                out << "\n*** You've found an item! ***" << endl;
+                currentSquare.item->print();
+                events.record(EVENT_FIND, currentSquare.item->name);
+            }
+        } else if (session.playerColumn > 0) {
+            out << "Cannot move left! There's a wall in the way." << endl;
+        } else {
+            out << "Cannot move left! You're at the left edge of the board." << endl;
+        }
+        session.commandCount++;
+        break;
+
+    case 'd':
+        out << "moving right" << endl;
+        if (session.playerColumn < board.width - 1 && !board.isWall(session.playerRow, session.playerColumn + 1)) {
+            session.playerColumn++;
+            events.at = {session.playerRow, session.playerColumn};
+            events.record(EVENT_MOVE, session.player->name);
+            Square& currentSquare = board.at(session.playerRow, session.playerColumn);
+            if (currentSquare.enemy) {
+                out << "\n*** You've encountered an enemy! ***" << endl;
+                currentSquare.enemy->printStats();
+                events.record(EVENT_ENCOUNTER, currentSquare.enemy->name, currentSquare.enemy->race);
+            }
+            if (currentSquare.item) {
+                out << "\n*** You've found an item! ***" << endl;
+                currentSquare.item->print();
+                events.record(EVENT_FIND, currentSquare.item->name);
+            }
+        } else if (session.playerColumn < board.width - 1) {
+            out << "Cannot move right! There's a wall in the way." << endl;
+        } else {
+            out << "Cannot move right! You're at the right edge of the board." << endl;
+        }
+        session.commandCount++;
+        break;
+
+    case 'h': {
+        out << "Drop what? (1=Weapon, 2=Armour, 3=Shield, 4=Ring): ";
+        char slot = 0;
+        input.readChar(slot);
+        if (slot == '1') {
+            session.player->dropWeapon();
+        } else if (slot == '2') {
+            session.player->dropArmour();
+        } else if (slot == '3') {
+            session.player->dropShield();
+        } else if (slot == '4') {
+            if (session.player->ring.empty()) {
+                out << "No rings to drop." << endl;
+            } else {
+                out << "Which ring? ";
+                for (size_t i = 0; i < session.player->ring.size(); ++i) {
+                    out << i+1 << ") " << session.player->ring[i]->name << "  ";
+                }
+                out << endl;
+                int rnum;
+                bool read = input.readInt(rnum);
+                if (!read || rnum < 1 || rnum > (int)session.player->ring.size()) {
+                    out << "Invalid ring selection! Please enter a number between 1 and " << session.player->ring.size() << "." << endl;
+                    input.discardLine();
+                } else {
+                    session.player->dropRing(rnum - 1);
+                }
+            }
+        } else {
+            out << "Invalid choice! Please enter 1, 2, 3, or 4." << endl;
+            input.discardLine();
+        }
+        session.commandCount++;
+        break;
+    }
+
+    case 'j': {
+        out << "attack" << endl;
+        auto& enemyOnSquare = board.at(session.playerRow, session.playerColumn).enemy;
+        session.player->printStats();
+        if (enemyOnSquare) {
+            enemyOnSquare->printStats();
+            attack(session.player.get(), enemyOnSquare.get());
+
+            if (enemyOnSquare->getTotalHealth() <= 0) {
+                out << enemyOnSquare->race << " Defeated!  Received 20 gold!" << endl;
+                board.removeEnemy(session.playerRow, session.playerColumn);
+                session.gold += 20;
+                if (!board.endless && board.enemyIndex.size() == 0) {
+                    out << "Congratulations! You defeated all the enemies and won the game!" << endl;
+                    session.gameOver = true;
+                }
+                break;
+            }
+
+            attack(enemyOnSquare.get(), session.player.get());
+            if (session.player->getTotalHealth() <= 0) {
+                out << "You Died! \n Game over!" << endl;
+                session.gameOver = true;
+            }
+        } else {
+            out << "No enemy to attack" << endl;
+        }
+        session.commandCount++;
+        break;
+    }
+
+    case 'k':
+        out << "Look" << endl;
+        out << "Information about current square: " << endl;
+        board.at(session.playerRow, session.playerColumn).printInfo();
+        session.commandCount++;
+        break;
+
+    case 'l':
+        session.player->printInventory();
+        out << "Total gold collected: " << session.gold << endl;
+        session.commandCount++;
+        break;
+
+    case 'g': {
+        out << "pickup";
+        auto& itemOnSquare = board.at(session.playerRow, session.playerColumn).item;
+        if (itemOnSquare) {
+            bool pickedUp = session.player->pickUp(itemOnSquare);
+            events.record(EVENT_PICKUP, itemOnSquare->name, InternedString(), pickedUp);
+            if (pickedUp) {
+                board.removeItem(session.playerRow, session.playerColumn);
+            }
+        } else {
+            out << "No item here!" << endl;
+        }
+    }
+        session.commandCount++;
+        break;
+
+    case 'n': {
+        out << "Nearest" << endl;
+        Position here = {session.playerRow, session.playerColumn};
+        Position target;
+        if (!board.enemyIndex.nearest(here, target)) {
+            out << "No enemies left on the board." << endl;
+        } else if (!board.findPath(here, target, session.route)) {
+            out << "Nearest enemy: " << target.row << " " << target.column
+                << " (no route from here)" << endl;
+        } else {
+            out << "Nearest enemy: " << target.row << " " << target.column
+                << " (" << session.route.size() << " steps)" << endl;
+        }
+        if (!board.itemIndex.nearest(here, target)) {
+            out << "No items left on the board." << endl;
+        } else if (!board.findPath(here, target, session.route)) {
+            out << "Nearest item: " << target.row << " " << target.column
+                << " (no route from here)" << endl;
+        } else {
+            out << "Nearest item: " << target.row << " " << target.column
+                << " (" << session.route.size() << " steps)" << endl;
+        }
+        session.commandCount++;
+        break;
+    }
+
+    case 'f':
+        board.fogOfWar = !board.fogOfWar;
+        out << "Fog of war " << (board.fogOfWar ? "on" : "off") << endl;
+        break;
+
+    case 'x':
+        out << "Exit" << endl;
+        session.gameOver = true;
+        break;
+
+    default:
+        out << "Invalid command! Please enter one of the following:" << endl;
+        out << "w/a/s/d = move, g = pickup, j = attack, h = drop, k = look, l = inventory, n = nearest, f = fog of war, v = save, x = exit" << endl;
+        break;
+    }
+
+    // Day/night cycle logic - switches every 5 commands
+    {
+        TIME_PHASE(PHASE_DAY_NIGHT);
+        if (session.commandCount % 10 < 5) {
+            if (session.isNight) {
+                session.isNight = false;
+                out << "It is now daytime." << endl;
+                board.setTimeOfDay(session.isNight);
+                events.record(EVENT_TIME_OF_DAY, InternedString(), InternedString(), session.isNight);
+            }
+        } else {
+            if (!session.isNight) {
+                session.isNight = true;
+                out << "It is now night." << endl;
+                board.setTimeOfDay(session.isNight);
+                events.record(EVENT_TIME_OF_DAY, InternedString(), InternedString(), session.isNight);
+            }
+        }
+    }
+
+    board.at(session.playerRow, session.playerColumn).player = session.player;
+    COUNT_SHARED_COPY(1);
+    board.updateFieldOfView({session.playerRow, session.playerColumn});
+}
+
+/**
+ * @brief Display current game state information
+ *
+ * @param playerRow Current row position of player on board
+ * @param playerColumn Current column position of player on board
+ * @param player Pointer to player character
+ * @param gold Current amount of gold collected
+ */
+void currentStats(int playerRow, int playerColumn, const shared_ptr<Character>& player, int gold) {
+    gameOut() << "Current location: " << playerRow << " " << playerColumn << endl;
+    player->printStats();
+    gameOut() << "Gold: " << gold << endl;
+}
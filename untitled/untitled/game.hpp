@@ -0,0 +1,163 @@
+/**
+ * @file game.hpp
+ * @brief State of one game session
+ *
+ * This file contains the GameSession class, which groups everything that
+ * makes up a game in progress so that it can be saved and restored, and
+ * playTurn(), which applies one command to it. A turn only depends on the
+ * session, the command and its follow-up answers, so replaying the same
+ * commands from a saved session gives the same game.
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <iostream>
+#include "board.hpp"
+#include "characters.hpp"
+
+using namespace std;
+
+/**
+ * @class GameSession
+ * @brief Board, player and turn counters of a game in progress
+ */
+class GameSession {
+public:
+    unique_ptr<Board> board;        ///< The game board
+    shared_ptr<Character> player;   ///< The player character
+    int playerRow = 0;              ///< Player's current row
+    int playerColumn = 0;           ///< Player's current column
+    int gold = 0;                   ///< Gold collected so far
+    int commandCount = 0;           ///< Commands that advanced the day/night clock
+    bool isNight = false;           ///< Current time of day
+    int turn = 0;                   ///< Commands played (every command except save)
+    bool gameOver = false;          ///< Set when the player exits, wins or dies
+    vector<Position> route;         ///< Reused by path queries so they don't allocate each turn
+};
+
+/**
+ * @struct GameSetup
+ * @brief Start-up answers that decide how a new game begins
+ *
+ * Together with the random seed these rebuild the starting position of a
+ * game exactly, which is where a replay of the whole game starts from.
+ */
+struct GameSetup {
+    bool endless = false;     ///< Endless world instead of a bounded board
+    int length = 12;          ///< Bounded board height
+    int breadth = 12;         ///< Bounded board width
+    bool generated = false;   ///< Bounded board filled chunk by chunk from worldSeed
+    unsigned worldSeed = 0;   ///< Endless or generated world seed
+    string name;              ///< Player's name
+    int race = 1;             ///< Player's race (1-5, as in the race menu)
+};
+
+/**
+ * @class TurnInput
+ * @brief Where a turn reads the answers to its follow-up prompts
+ *
+ * Answers come from a stream (cin while playing, a recorded line when a
+ * journal is replayed) and are copied into record, so a turn can be written
+ * down and played again exactly.
+ */
+class TurnInput {
+public:
+    istream& in;    ///< Stream answers are read from
+    string record;  ///< Answers read so far, separated by spaces
+
+    /**
+     * @brief Constructor
+     *
+     * @param stream Stream to read answers from
+     */
+    TurnInput(istream& stream) : in(stream) {}
+
+    /**
+     * @brief Read one character answer and remember it
+     *
+     * @param c Set to the character read
+     * @return false if the stream had no more input
+     */
+    bool readChar(char& c);
+
+    /**
+     * @brief Read a number answer and remember it
+     *
+     * @param value Set to the number read
+     * @return false if the answer was not a number
+     */
+    bool readInt(int& value);
+
+    /**
+     * @brief Throw away the rest of the current input line after a bad answer
+     *
+     * Stops early at the end of the input that has already arrived.
+     */
+    void discardLine();
+};
+
+/**
+ * @brief Create a player of a race chosen from the race menu
+ *
+ * @param race 1 = Human, 2 = Elf, 3 = Dwarf, 4 = Hobbit, 5 = Orc
+ * @param name Player's name
+ * @return New character, or nullptr for any other number
+ */
+shared_ptr<Character> makePlayer(int race, const string& name);
+
+/**
+ * @brief Set a session up for a new game
+ *
+ * Uses the current state of gameRandom() to place the enemies and items.
+ *
+ * @param session Session to replace
+ * @param setup Start-up answers
+ */
+void newGame(GameSession& session, const GameSetup& setup);
+
+/**
+ * @brief Hash of the session's counters, player and random state
+ *
+ * Two sessions that played the same turns from the same start have the
+ * same digest; the journal stores it with every checkpoint so replays can
+ * check that they reproduce the game exactly.
+ *
+ * @param session Session to hash
+ * @return 64-bit digest
+ */
+uint64_t sessionDigest(const GameSession& session);
+
+/**
+ * @brief Handle combat between two characters
+ *
+ * @param attacker Character initiating the attack
+ * @param defender Character being attacked
+ */
+void attack(Character* attacker, Character* defender);
+
+/**
+ * @brief Apply one command to the session
+ *
+ * Everything the command changes (position, combat, items, clock, time of
+ * day, field of view) happens here; printing the stats and board is left to
+ * the caller.
+ *
+ * @param session Session to update
+ * @param choice Command character
+ * @param input Where follow-up answers are read from
+ */
+void playTurn(GameSession& session, char choice, TurnInput& input);
+
+/**
+ * @brief Display current game state information (location, player stats, gold)
+ *
+ * @param playerRow Current row position of player on board
+ * @param playerColumn Current column position of player on board
+ * @param player Pointer to player character
+ * @param gold Current amount of gold collected
+ */
+void currentStats(int playerRow, int playerColumn, const shared_ptr<Character>& player, int gold);
@@ -0,0 +1,27 @@
+/**
+ * @file interned.cpp
+ * @brief Implementation of the string table
+ *
+ * @author [Ish Soundankar]
+ */
+#include "interned.hpp"
+
+/**
+ * @brief Id of a string, adding it to the table the first time it is seen
+ *
+ * Pseudo-code:
+ * 1. IF the text is in the table: RETURN its id
+ * 2. Store a copy at the end of the table, index it by that copy
+ * 3. RETURN the new id (the old size of the table)
+ *
+ * @param text String to intern
+ * @return Its id
+ */
+uint32_t StringTable::intern(string_view text) {
+    auto found = ids.find(text);
+    if (found != ids.end()) return found->second;
+    uint32_t id = (uint32_t)strings.size();
+    strings.emplace_back(text);
+    ids.emplace(string_view(strings.back()), id);
+    return id;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file interned.hpp
+ * @brief Interned strings for names that many entities share
+ *
+ * This file contains the StringTable, which stores each distinct string
+ * once and numbers it, and InternedString, a 4-byte handle to a string in
+ * the table. Characters keep their name and race and items their name as
+ * InternedStrings, so a million enemies of five races hold ids instead of
+ * two std::string objects each, and printing looks the text up by id.
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace std;
+
+/**
+ * @class StringTable
+ * @brief Every distinct string interned so far, numbered from 0
+ *
+ * Strings are never removed, so ids and references to the text stay valid
+ * for the whole run. Id 0 is the empty string.
+ */
+class StringTable {
+public:
+    deque<string> strings;                   ///< Text of each id (deque: never moves a string)
+    unordered_map<string_view, uint32_t> ids;  ///< Id of each text, keyed on the stored strings
+
+    StringTable() { intern(string()); }
+    StringTable(const StringTable&) = delete;
+    StringTable& operator=(const StringTable&) = delete;
+
+    /**
+     * @brief Id of a string, adding it to the table the first time it is seen
+     *
+     * @param text String to intern
+     * @return Its id
+     */
+    uint32_t intern(string_view text);
+
+    /**
+     * @brief Text of an id
+     */
+    const string& text(uint32_t id) const { return strings[id]; }
+};
+
+/**
+ * @brief The game's string table
+ *
+ * Created on first use, so items created during static initialisation
+ * (ItemsDB.h) can already intern their names.
+ */
+inline StringTable& stringTable() {
+    static StringTable table;
+    return table;
+}
+
+/**
+ * @class InternedString
+ * @brief A string stored once in the string table, held by id
+ *
+ * Assigning a string interns it; the text is read back with str() or the
+ * conversion to const string&, and printed with <<. Two interned strings
+ * are equal exactly when their ids are.
+ */
+class InternedString {
+public:
+    uint32_t id = 0;  ///< Id in stringTable() (0 = empty string)
+
+    InternedString() {}
+    InternedString(const string& text) : id(stringTable().intern(text)) {}
+    InternedString(const char* text) : id(stringTable().intern(text)) {}
+
+    /**
+     * @brief The text
+     */
+    const string& str() const { return stringTable().text(id); }
+    operator const string&() const { return str(); }
+
+    bool operator==(const InternedString& other) const { return id == other.id; }
+    bool operator!=(const InternedString& other) const { return id != other.id; }
+};
+
+/**
+ * @brief Print the text of an interned string
+ */
+inline ostream& operator<<(ostream& out, const InternedString& text) {
+    return out << text.str();
+}
@@ -11,6 +11,9 @@
 #pragma once
 #include <string>
 #include <iostream>
+#include "interned.hpp"
+#include "textbuffer.hpp"
+#include "output.hpp"
 using namespace std;
 
 /**
@@ -18,12 +21,12 @@ using namespace std;
  * @brief Base class for all items in the game
  *
  * This abstract base class provides the common interface for all items.
- * Derived classes override the print() method to display item-specific information.
+ * Derived classes override the format() method to display item-specific information.
  */
 class Item {
 public:
-    string name;   ///< Name of the item
-    int weight;    ///< Weight of the item (affects carrying capacity)
+    InternedString name;  ///< Name of the item (interned)
+    int weight;           ///< Weight of the item (affects carrying capacity)
 
     /**
      * @brief Constructor to initialize item
@@ -37,12 +40,24 @@ public:
     }
 
     /**
-     * @brief Virtual function to print item information
+     * @brief Virtual function to format item information
      *
      * Can be overridden by derived classes to display item-specific information.
+     *
+     * @param out Buffer the line is formatted into
+     */
+    virtual void format(TextBuffer& out) const {
+        out << name << "(Weight: " << weight << '\n';
+    }
+
+    /**
+     * @brief Print item information (format() written to gameOut() in one go)
      */
-    virtual void print() {
-        cout << name << "(Weight: " << weight << endl;
+    void print() const {
+        ostream& out = gameOut();
+        if (!out) return;
+        TextLine<128> line(out);
+        format(line);
     }
 
     /**
@@ -73,11 +88,11 @@ public:
     }
 
     /**
-     * @brief Override print function to display weapon-specific information
+     * @brief Override format function to display weapon-specific information
      */
-    virtual void print() override {
-        cout << name << "(Weapon, Attack + " << attack_inc
-             << ",Weight: " << weight << endl;
+    void format(TextBuffer& out) const override {
+        out << name << "(Weapon, Attack + " << attack_inc
+            << ",Weight: " << weight << '\n';
     }
 };
 
@@ -106,11 +121,11 @@ public:
     }
 
     /**
-     * @brief Override print function to display armor-specific information
+     * @brief Override format function to display armor-specific information
      */
-    virtual void print() override {
-        cout << name << "(Armour, Defence + " << defence_inc
-             << ", Attack - " << attack_dec << ",Weight: " << weight << endl;
+    void format(TextBuffer& out) const override {
+        out << name << "(Armour, Defence + " << defence_inc
+            << ", Attack - " << attack_dec << ",Weight: " << weight << '\n';
     }
 };
 
@@ -133,11 +148,11 @@ public:
     Shield(string n, int w, int def, int atk) : Armour(n, w, def, atk) {}
 
     /**
-     * @brief Override print function to display shield-specific information
+     * @brief Override format function to display shield-specific information
      */
-    virtual void print() override {
-        cout << name << "(Shield, Defence + " << defence_inc
-             << ", Attack - " << attack_dec << ",Weight: " << weight << endl;
+    void format(TextBuffer& out) const override {
+        out << name << "(Shield, Defence + " << defence_inc
+            << ", Attack - " << attack_dec << ",Weight: " << weight << '\n';
     }
 };
 
@@ -165,12 +180,12 @@ public:
         : Item(n, w), health(hel), strength_inc(str) {}
 
     /**
-     * @brief Override print function to display ring-specific information
+     * @brief Override format function to display ring-specific information
      */
-    void print() override {
-        cout << name << " (Ring, Health "
-             << (health >= 0 ? "+" : "") << health
-             << ", Strength + " << strength_inc
-             << ", Weight: " << weight << ")\n";
+    void format(TextBuffer& out) const override {
+        out << name << " (Ring, Health "
+            << (health >= 0 ? "+" : "") << health
+            << ", Strength + " << strength_inc
+            << ", Weight: " << weight << ")\n";
     }
 };
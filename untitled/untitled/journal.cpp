@@ -0,0 +1,321 @@
+/**
+ * @file journal.cpp
+ * @brief Implementation of the command journal, crash recovery and replay
+ *
+ * @author [Ish Soundankar]
+ */
+#include "journal.hpp"
+#include "snapshot.hpp"
+#include "serialize.hpp"
+#include "pager.hpp"
+#include "random.hpp"
+#include "output.hpp"
+#include <cstring>
+#include <climits>
+#include <sstream>
+
+/**
+ * @brief Append the setup record
+ */
+static void putSetup(ByteWriter& out, bool fromCheckpoint, const GameSetup& setup) {
+    out.put<uint8_t>(fromCheckpoint ? 1 : 0);
+    out.put<uint8_t>(setup.endless ? 1 : setup.generated ? 2 : 0);
+    out.put<int32_t>(setup.length);
+    out.put<int32_t>(setup.breadth);
+    out.put<uint32_t>(setup.worldSeed);
+    out.putString(setup.name);
+    out.put<uint8_t>((uint8_t)setup.race);
+}
+
+/**
+ * @brief Append one turn or checkpoint record
+ */
+static void putRecord(ByteWriter& out, uint32_t turn, char command, const string& answers) {
+    out.put<uint32_t>(turn);
+    out.put<uint8_t>((uint8_t)command);
+    out.putString(answers);
+}
+
+/**
+ * @brief Name of the checkpoint file written at a turn
+ *
+ * @param prefix Checkpoint file prefix
+ * @param turn Turn of the checkpoint
+ * @return "<prefix>.<turn>"
+ */
+string checkpointFileName(const string& prefix, int turn) {
+    return prefix + "." + to_string(turn);
+}
+
+/**
+ * @brief Start a new journal for a session and checkpoint it
+ *
+ * Pseudo-code:
+ * 1. Create the journal file (replacing an old one)
+ * 2. Write the header and the setup record
+ * 3. Write the first checkpoint, so recovery always has a starting point
+ *
+ * @param session Session about to be played
+ * @param randomSeed Seed the game's random generator started from
+ * @param setup Start-up answers, or nullptr if the session was loaded
+ * @return true on success
+ */
+bool Journal::start(GameSession& session, uint64_t randomSeed, const GameSetup* setup) {
+    close();
+    checkpoints.clear();
+    file = fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    JournalHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "APGJ", 4);
+    header.version = JOURNAL_VERSION;
+    header.randomSeed = randomSeed;
+
+    record.clear();
+    ByteWriter out(record);
+    putSetup(out, setup == nullptr, setup ? *setup : GameSetup());
+    if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+        fwrite(record.data(), 1, record.size(), file) != record.size() || fflush(file) != 0) {
+        close();
+        return false;
+    }
+    return checkpoint(session);
+}
+
+/**
+ * @brief Keep appending to a journal that was just replayed
+ *
+ * Pseudo-code:
+ * 1. Write the header, setup and every record up to lastTurn to a
+ *    temporary file (this drops a record cut short by the crash)
+ * 2. Move it over the journal and open it for appending
+ * 3. Remember which checkpoints the journal refers to
+ *
+ * @param contents Journal as read back
+ * @param lastTurn Last turn the replay reached; later records are dropped
+ * @return true on success
+ */
+bool Journal::resume(const JournalContents& contents, int lastTurn) {
+    close();
+    checkpoints.clear();
+    record.clear();
+    ByteWriter out(record);
+    putSetup(out, contents.fromCheckpoint, contents.setup);
+    for (const JournalRecord& r : contents.records) {
+        if ((int)r.turn > lastTurn) break;
+        putRecord(out, r.turn, r.command, r.answers);
+        if (r.command == 0) checkpoints.push_back((int)r.turn);
+    }
+
+    string temporary = path + ".tmp";
+    FILE* rewrite = fopen(temporary.c_str(), "wb");
+    if (!rewrite) return false;
+    bool ok = fwrite(&contents.header, sizeof(contents.header), 1, rewrite) == 1 &&
+              fwrite(record.data(), 1, record.size(), rewrite) == record.size();
+    if (fclose(rewrite) != 0 || !ok) {
+        remove(temporary.c_str());
+        return false;
+    }
+    remove(path.c_str());
+    if (rename(temporary.c_str(), path.c_str()) != 0) return false;
+    file = fopen(path.c_str(), "ab");
+    return file != nullptr;
+}
+
+/**
+ * @brief Record a turn that playTurn() has just applied
+ *
+ * Pseudo-code:
+ * 1. Build the record (turn, command, answers) in the reused buffer
+ * 2. Write it with one buffered write and flush it to the operating system
+ * 3. IF the turn is a multiple of checkpointInterval: checkpoint the session
+ *
+ * @param session Session after the turn
+ * @param command Command character
+ * @param answers Follow-up answers the turn read (TurnInput::record)
+ * @return true if the record was written
+ */
+bool Journal::append(GameSession& session, char command, const string& answers) {
+    if (!file) return false;
+
+    record.clear();
+    ByteWriter out(record);
+    putRecord(out, (uint32_t)session.turn, command, answers);
+    bool ok = fwrite(record.data(), 1, record.size(), file) == record.size() && fflush(file) == 0;
+
+    if (ok && checkpointInterval > 0 && session.turn % checkpointInterval == 0) {
+        checkpoint(session);
+    }
+    return ok;
+}
+
+/**
+ * @brief Write the session to a checkpoint file and note it in the journal
+ *
+ * Pseudo-code:
+ * 1. Save the session to "<checkpointPath>.<turn>" (written to a temporary
+ *    file and renamed, so a crash leaves no half-written checkpoint)
+ * 2. Append a checkpoint record holding the session digest
+ * 3. Delete the oldest checkpoint files beyond keepCheckpoints, always
+ *    keeping the first one
+ *
+ * @param session Session to save
+ * @return true on success
+ */
+bool Journal::checkpoint(GameSession& session) {
+    if (!file || !saveSnapshot(checkpointFileName(checkpointPath, session.turn), session)) return false;
+
+    uint64_t digest = sessionDigest(session);
+    record.clear();
+    ByteWriter out(record);
+    putRecord(out, (uint32_t)session.turn, 0, string((const char*)&digest, sizeof(digest)));
+    if (fwrite(record.data(), 1, record.size(), file) != record.size() || fflush(file) != 0) return false;
+
+    checkpoints.push_back(session.turn);
+    while ((int)checkpoints.size() > keepCheckpoints + 1) {
+        remove(checkpointFileName(checkpointPath, checkpoints[1]).c_str());
+        checkpoints.erase(checkpoints.begin() + 1);
+    }
+    return true;
+}
+
+/**
+ * @brief Close the journal file
+ */
+void Journal::close() {
+    if (file) fclose(file);
+    file = nullptr;
+}
+
+/**
+ * @brief Read a whole journal file
+ *
+ * Pseudo-code:
+ * 1. Map the file and check the header
+ * 2. Read the setup record
+ * 3. Read records until the end of the file or one that is cut short
+ *
+ * @param path Journal file name
+ * @param contents Filled with the header, setup and records
+ * @return false if the file is missing or not a journal
+ */
+bool readJournal(const string& path, JournalContents& contents) {
+    MappedFile journal;
+    if (!journal.open(path) || journal.size < sizeof(JournalHeader)) return false;
+    memcpy(&contents.header, journal.data, sizeof(JournalHeader));
+    if (memcmp(contents.header.magic, "APGJ", 4) != 0 || contents.header.version != JOURNAL_VERSION) {
+        return false;
+    }
+
+    ByteReader in(journal.data + sizeof(JournalHeader), journal.size - sizeof(JournalHeader));
+    contents.fromCheckpoint = in.get<uint8_t>() != 0;
+    uint8_t world = in.get<uint8_t>();  // 0 = standard, 1 = endless, 2 = generated
+    contents.setup.endless = world == 1;
+    contents.setup.generated = world == 2;
+    contents.setup.length = in.get<int32_t>();
+    contents.setup.breadth = in.get<int32_t>();
+    contents.setup.worldSeed = in.get<uint32_t>();
+    contents.setup.name = in.getString();
+    contents.setup.race = in.get<uint8_t>();
+    if (!in.ok) return false;
+
+    contents.records.clear();
+    while (in.next < in.end) {
+        JournalRecord r;
+        r.turn = in.get<uint32_t>();
+        r.command = (char)in.get<uint8_t>();
+        r.answers = in.getString();
+        r.digest = 0;
+        if (!in.ok) break;
+        if (r.command == 0 && r.answers.size() == sizeof(r.digest)) {
+            memcpy(&r.digest, r.answers.data(), sizeof(r.digest));
+        }
+        contents.records.push_back(r);
+    }
+    return true;
+}
+
+/**
+ * @brief Rebuild the session at a turn of a journalled game
+ *
+ * Pseudo-code:
+ * 1. FOR each checkpoint record at or before toTurn, newest first:
+ *    IF its file loads: start from it and stop looking
+ * 2. IF none loaded: rebuild the start of the game from the seed and setup
+ *    (RETURN false if the game started from a save that is gone)
+ * 3. Silence the screen output
+ * 4. FOR each record:
+ *    a. Checkpoint at the current turn: compare its digest with the session
+ *    b. Turn already played or a checkpoint: skip it
+ *    c. Past toTurn or not the next turn: stop
+ *    d. Play it again with its recorded answers; stop if the game ended
+ * 5. Restore the screen output
+ *
+ * @param contents Journal to replay
+ * @param checkpointPath Prefix of the checkpoint save files
+ * @param toTurn Last turn to play (the game's end if it is reached first)
+ * @param session Session to replace
+ * @param result Filled with where the replay started and what it checked
+ * @return false if there was no way to rebuild the starting position
+ */
+bool replayJournal(const JournalContents& contents, const string& checkpointPath, int toTurn,
+                   GameSession& session, ReplayResult& result) {
+    result = ReplayResult();
+    bool started = false;
+    for (auto it = contents.records.rbegin(); it != contents.records.rend() && !started; ++it) {
+        if (it->command != 0 || (int)it->turn > toTurn) continue;
+        started = loadSnapshot(checkpointFileName(checkpointPath, it->turn), session);
+    }
+    if (!started) {
+        if (contents.fromCheckpoint) return false;
+        gameRandom().state = contents.header.randomSeed;
+        newGame(session, contents.setup);
+        if (!session.player) return false;
+    }
+    result.startTurn = session.turn;
+
+    RedirectOutput silent(nullptr);  // Replayed turns print nothing (and format nothing)
+    for (const JournalRecord& r : contents.records) {
+        if (r.command == 0) {
+            if ((int)r.turn == session.turn) {
+                result.checkpointsChecked++;
+                if (r.digest != sessionDigest(session) && result.mismatchTurn < 0) {
+                    result.mismatchTurn = session.turn;
+                }
+            }
+            continue;
+        }
+        if ((int)r.turn <= session.turn) continue;
+        if ((int)r.turn > toTurn || (int)r.turn != session.turn + 1 || session.gameOver) break;
+
+        istringstream recorded(r.answers);
+        TurnInput input(recorded);
+        playTurn(session, r.command, input);
+        result.turnsPlayed++;
+    }
+    return true;
+}
+
+/**
+ * @brief Rebuild an interrupted game and keep journalling it
+ *
+ * Pseudo-code:
+ * 1. Read the journal and replay all of it
+ * 2. IF the game had already ended: RETURN false
+ * 3. Reopen the journal for appending after the last turn replayed
+ *
+ * @param journal Journal of the interrupted game (reopened for appending)
+ * @param session Session to replace
+ * @return true if a game still in progress was recovered
+ */
+bool recoverSession(Journal& journal, GameSession& session) {
+    JournalContents contents;
+    ReplayResult result;
+    if (!readJournal(journal.path, contents) ||
+        !replayJournal(contents, journal.checkpointPath, INT_MAX, session, result) ||
+        session.gameOver) {
+        return false;
+    }
+    return journal.resume(contents, session.turn);
+}
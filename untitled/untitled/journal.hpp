@@ -0,0 +1,199 @@
+/**
+ * @file journal.hpp
+ * @brief Write-ahead command journal, checkpoints and replay
+ *
+ * This file contains the Journal class, which keeps a crashed game
+ * recoverable without saving the whole board every turn, and the functions
+ * that read a journal back and replay it. Each turn appends one small record
+ * (turn number, command, follow-up answers) to the journal file, and every
+ * checkpointInterval turns the whole session is written to a numbered
+ * checkpoint save file. A journal file holds, in order:
+ *
+ * 1. JournalHeader (magic, version, random seed the game started with)
+ * 2. The setup record: a flag saying whether the game started from its first
+ *    checkpoint (a loaded save), then the GameSetup answers
+ * 3. One record per turn: u32 turn, u8 command, u16 answer length, answers.
+ *    Command 0 marks a checkpoint; its answers are the session digest.
+ *
+ * A journal is enough to rebuild any turn of the game: start from the
+ * nearest checkpoint at or before it (or from the setup and seed) and play
+ * the records after it again.
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "game.hpp"
+
+using namespace std;
+
+/**
+ * @struct JournalHeader
+ * @brief Fixed-size start of a journal file
+ */
+struct JournalHeader {
+    char magic[4];        ///< "APGJ"
+    uint32_t version;     ///< JOURNAL_VERSION of the writer
+    uint64_t randomSeed;  ///< gameRandom() state when the game started
+};
+
+// Bump whenever the format changes, or the rules a replay depends on do
+// (3: race defences run, so a Hobbit's defence takes a random number;
+// 4: enemies and items are placed by spawn rules)
+const uint32_t JOURNAL_VERSION = 4;
+
+/**
+ * @struct JournalRecord
+ * @brief One turn (or checkpoint marker) read back from a journal
+ */
+struct JournalRecord {
+    uint32_t turn;    ///< Turn number after the command
+    char command;     ///< Command character (0 for a checkpoint)
+    string answers;   ///< Follow-up answers (TurnInput::record)
+    uint64_t digest;  ///< sessionDigest() at a checkpoint, otherwise 0
+};
+
+/**
+ * @struct JournalContents
+ * @brief Everything stored in a journal file
+ */
+struct JournalContents {
+    JournalHeader header;            ///< File header
+    bool fromCheckpoint = false;     ///< Game started from a loaded save, not from setup
+    GameSetup setup;                 ///< Start-up answers (unused if fromCheckpoint)
+    vector<JournalRecord> records;   ///< Complete records in file order
+};
+
+/**
+ * @struct ReplayResult
+ * @brief What a replay did
+ */
+struct ReplayResult {
+    int startTurn = 0;           ///< Turn the replay started from (checkpoint or 0)
+    int turnsPlayed = 0;         ///< Records played again
+    int checkpointsChecked = 0;  ///< Checkpoint digests compared
+    int mismatchTurn = -1;       ///< First checkpoint whose digest differed (-1 = none)
+};
+
+/**
+ * @brief Name of the checkpoint file written at a turn
+ *
+ * @param prefix Checkpoint file prefix
+ * @param turn Turn of the checkpoint
+ * @return "<prefix>.<turn>"
+ */
+string checkpointFileName(const string& prefix, int turn);
+
+/**
+ * @class Journal
+ * @brief Append-only log of the turns played since the game started
+ */
+class Journal {
+public:
+    string path;                   ///< Journal file name
+    string checkpointPath;         ///< Prefix of the checkpoint save files
+    int checkpointInterval = 200;  ///< Turns between checkpoints
+    int keepCheckpoints = 8;       ///< Latest checkpoints kept besides the first
+    FILE* file = nullptr;          ///< Open journal (nullptr when not recording)
+    vector<char> record;           ///< Reused buffer for one turn record
+    vector<int> checkpoints;       ///< Turns of the checkpoint files on disk
+
+    /**
+     * @brief Constructor
+     *
+     * @param journalPath Journal file name
+     * @param checkpoint Prefix of the checkpoint save files
+     */
+    Journal(const string& journalPath, const string& checkpoint)
+        : path(journalPath), checkpointPath(checkpoint) {}
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    /**
+     * @brief Destructor closes the journal
+     */
+    ~Journal() { close(); }
+
+    /**
+     * @brief Start a new journal for a session and checkpoint it
+     *
+     * @param session Session about to be played
+     * @param randomSeed Seed the game's random generator started from
+     * @param setup Start-up answers, or nullptr if the session was loaded
+     * @return true on success
+     */
+    bool start(GameSession& session, uint64_t randomSeed, const GameSetup* setup);
+
+    /**
+     * @brief Keep appending to a journal that was just replayed
+     *
+     * @param contents Journal as read back
+     * @param lastTurn Last turn the replay reached; later records are dropped
+     * @return true on success
+     */
+    bool resume(const JournalContents& contents, int lastTurn);
+
+    /**
+     * @brief Record a turn that playTurn() has just applied
+     *
+     * Writes one record and flushes it, then checkpoints the session if
+     * checkpointInterval turns have passed.
+     *
+     * @param session Session after the turn
+     * @param command Command character
+     * @param answers Follow-up answers the turn read (TurnInput::record)
+     * @return true if the record was written
+     */
+    bool append(GameSession& session, char command, const string& answers);
+
+    /**
+     * @brief Write the session to a checkpoint file and note it in the journal
+     *
+     * @param session Session to save
+     * @return true on success
+     */
+    bool checkpoint(GameSession& session);
+
+    /**
+     * @brief Close the journal file
+     */
+    void close();
+};
+
+/**
+ * @brief Read a whole journal file
+ *
+ * A record cut short by a crash ends the list.
+ *
+ * @param path Journal file name
+ * @param contents Filled with the header, setup and records
+ * @return false if the file is missing or not a journal
+ */
+bool readJournal(const string& path, JournalContents& contents);
+
+/**
+ * @brief Rebuild the session at a turn of a journalled game
+ *
+ * Nothing is printed while the turns are played.
+ *
+ * @param contents Journal to replay
+ * @param checkpointPath Prefix of the checkpoint save files
+ * @param toTurn Last turn to play (the game's end if it is reached first)
+ * @param session Session to replace
+ * @param result Filled with where the replay started and what it checked
+ * @return false if there was no way to rebuild the starting position
+ */
+bool replayJournal(const JournalContents& contents, const string& checkpointPath, int toTurn,
+                   GameSession& session, ReplayResult& result);
+
+/**
+ * @brief Rebuild an interrupted game and keep journalling it
+ *
+ * @param journal Journal of the interrupted game (reopened for appending)
+ * @param session Session to replace
+ * @return true if a game still in progress was recovered
+ */
+bool recoverSession(Journal& journal, GameSession& session);
@@ -0,0 +1,161 @@
+/**
+ * @file keyboard.cpp
+ * @brief Implementation of raw-mode keyboard input
+ *
+ * @author [Ish Soundankar]
+ */
+#include "keyboard.hpp"
+#include <chrono>
+#ifdef _WIN32
+#include <conio.h>
+#include <io.h>
+#include <windows.h>
+#else
+#include <termios.h>
+#include <poll.h>
+#include <unistd.h>
+#include <csignal>
+#include <cstdlib>
+#include <cerrno>
+
+static struct termios lineMode;      // Terminal settings before begin()
+static volatile bool rawActive = false;
+
+/**
+ * @brief Restore the terminal settings saved by begin()
+ */
+static void restoreTerminal() {
+    if (rawActive) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &lineMode);
+        rawActive = false;
+    }
+}
+
+/**
+ * @brief Restore the terminal, then let the signal end the game as usual
+ */
+static void restoreOnSignal(int signal) {
+    restoreTerminal();
+    std::signal(signal, SIG_DFL);
+    std::raise(signal);
+}
+#endif
+
+/**
+ * @brief Switch the terminal to raw mode (no line buffering, no echo)
+ *
+ * Pseudo-code:
+ * 1. IF input is not a terminal or raw mode is on: RETURN
+ * 2. POSIX: save the settings, turn off ICANON and ECHO (keys arrive one at
+ *    a time, Ctrl-C still works) and restore them at exit or on a signal
+ *    Windows: nothing to do, conio reads single keys without echo
+ */
+void KeyboardInput::begin() {
+    if (raw) return;
+#ifdef _WIN32
+    raw = _isatty(_fileno(stdin)) != 0;
+#else
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &lineMode) != 0) return;
+    struct termios keys = lineMode;
+    keys.c_lflag &= ~(ICANON | ECHO);
+    keys.c_cc[VMIN] = 1;
+    keys.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &keys) != 0) return;
+    raw = true;
+    rawActive = true;
+
+    static bool handlersInstalled = false;
+    if (!handlersInstalled) {
+        atexit(restoreTerminal);
+        std::signal(SIGINT, restoreOnSignal);
+        std::signal(SIGTERM, restoreOnSignal);
+        handlersInstalled = true;
+    }
+#endif
+}
+
+/**
+ * @brief Put the terminal back into line mode
+ */
+void KeyboardInput::end() {
+    if (!raw) return;
+#ifndef _WIN32
+    restoreTerminal();
+#endif
+    raw = false;
+}
+
+/**
+ * @brief Check whether a key can be read without waiting
+ *
+ * @return true if cin has buffered input or a key has arrived
+ */
+bool KeyboardInput::pending() {
+    if (cin.rdbuf()->in_avail() > 0) return true;
+#ifdef _WIN32
+    return raw && _kbhit();
+#else
+    struct pollfd input = {STDIN_FILENO, POLLIN, 0};
+    return poll(&input, 1, 0) > 0 && (input.revents & POLLIN);
+#endif
+}
+
+/**
+ * @brief Wait for a key
+ *
+ * Pseudo-code:
+ * 1. IF cin has buffered input: RETURN its next character
+ * 2. POSIX: poll() standard input for up to timeoutMs, then read one byte
+ *    Windows console: check _kbhit() every 10 ms until the timeout, then
+ *    read the key with _getch(); redirected input is read through cin
+ * 3. RETURN KEY_TIMEOUT if nothing arrived, KEY_CLOSED at end of input
+ *
+ * @param timeoutMs Milliseconds to wait (negative = wait forever)
+ * @return Key code (0-255), KEY_TIMEOUT or KEY_CLOSED
+ */
+int KeyboardInput::readKey(int timeoutMs) {
+    streambuf* buffered = cin.rdbuf();
+    if (buffered->in_avail() > 0) return buffered->sbumpc();
+#ifdef _WIN32
+    if (!raw) {
+        int c = buffered->sbumpc();
+        return c == char_traits<char>::eof() ? KEY_CLOSED : c;
+    }
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+    while (!_kbhit()) {
+        if (timeoutMs >= 0 && chrono::steady_clock::now() >= deadline) return KEY_TIMEOUT;
+        Sleep(10);
+    }
+    return (unsigned char)_getch();
+#else
+    struct pollfd input = {STDIN_FILENO, POLLIN, 0};
+    int ready = poll(&input, 1, timeoutMs);
+    if (ready == 0 || (ready < 0 && errno == EINTR)) return KEY_TIMEOUT;
+    if (ready < 0) return KEY_CLOSED;
+    unsigned char key;
+    return read(STDIN_FILENO, &key, 1) == 1 ? key : KEY_CLOSED;
+#endif
+}
+
+/**
+ * @brief Wait for the next key
+ *
+ * @return The key, or eof when input has ended
+ */
+KeyStreamBuffer::int_type KeyStreamBuffer::underflow() {
+    int key;
+    do {
+        key = keys.readKey(-1);
+    } while (key == KEY_TIMEOUT);
+    if (key == KEY_CLOSED) return traits_type::eof();
+    current = (char)key;
+    setg(&current, &current, &current + 1);
+    return traits_type::to_int_type(current);
+}
+
+/**
+ * @brief 1 if a key is waiting, otherwise 0
+ */
+streamsize KeyStreamBuffer::showmanyc() {
+    return keys.pending() ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file keyboard.hpp
+ * @brief Single-keypress input that can wait with a timeout
+ *
+ * This file contains the KeyboardInput class, which switches the terminal
+ * out of line mode so each key reaches the game as soon as it is pressed,
+ * and KeyStreamBuffer, which lets stream code (TurnInput) read the same
+ * keys. On POSIX systems the terminal is set up with termios and waited on
+ * with poll(); on Windows the console is read with conio. When input is not
+ * a terminal (a script piped in) keys are read from it unchanged.
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <iostream>
+#include <streambuf>
+
+using namespace std;
+
+const int KEY_TIMEOUT = -1;  ///< readKey() result: no key before the timeout
+const int KEY_CLOSED = -2;   ///< readKey() result: input has ended
+
+/**
+ * @class KeyboardInput
+ * @brief Keys from standard input, one at a time
+ *
+ * Keys that cin has already buffered (typed or piped before the switch to
+ * raw mode) are handed out first, so no input is lost. main() turns off
+ * stdio synchronisation so cin's buffer can be seen.
+ */
+class KeyboardInput {
+public:
+    bool raw = false;  ///< Terminal is in raw mode (restored by end())
+
+    KeyboardInput() {}
+    KeyboardInput(const KeyboardInput&) = delete;
+    KeyboardInput& operator=(const KeyboardInput&) = delete;
+
+    /**
+     * @brief Destructor puts the terminal back into line mode
+     */
+    ~KeyboardInput() { end(); }
+
+    /**
+     * @brief Switch the terminal to raw mode (no line buffering, no echo)
+     *
+     * Does nothing when input is not a terminal. The terminal is also
+     * restored if the game exits or is interrupted while in raw mode.
+     */
+    void begin();
+
+    /**
+     * @brief Put the terminal back into line mode
+     */
+    void end();
+
+    /**
+     * @brief Check whether a key can be read without waiting
+     */
+    bool pending();
+
+    /**
+     * @brief Wait for a key
+     *
+     * @param timeoutMs Milliseconds to wait (negative = wait forever)
+     * @return Key code (0-255), KEY_TIMEOUT or KEY_CLOSED
+     */
+    int readKey(int timeoutMs);
+};
+
+/**
+ * @class KeyStreamBuffer
+ * @brief Stream buffer reading from a KeyboardInput
+ *
+ * Wrapped in an istream it lets follow-up prompts use >> on single
+ * keypresses. in_avail() reports whether a key has already arrived.
+ */
+class KeyStreamBuffer : public streambuf {
+public:
+    KeyboardInput& keys;  ///< Where keys come from
+    char current;         ///< Last key read (the whole get area)
+
+    /**
+     * @brief Constructor
+     *
+     * @param keyboard Key source
+     */
+    KeyStreamBuffer(KeyboardInput& keyboard) : keys(keyboard), current(0) {}
+
+protected:
+    /**
+     * @brief Wait for the next key
+     */
+    int_type underflow() override;
+
+    /**
+     * @brief 1 if a key is waiting, otherwise 0
+     */
+    streamsize showmanyc() override;
+};
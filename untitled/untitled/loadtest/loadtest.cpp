@@ -0,0 +1,325 @@
+/**
+ * @file loadtest.cpp
+ * @brief Headless load test: many games in one process, played by scripts
+ *
+ * Usage: loadtest [--sessions N] [--turns T] [--size S | --endless]
+ *                 [--players random|greedy|mixed] [--no-render]
+ *                 [--events sync|async] [--sink-delay US] [--silent]
+ *
+ * Starts N game sessions (100 unless given) and plays T turns in each
+ * (10,000 unless given), one turn per session in turn, the way a server
+ * hosting N players would. Each session is played by a scripted player:
+ * a random walker picks any of w/a/s/d/g/j, a greedy player fights the
+ * enemy it stands on, picks up what it finds and otherwise walks towards
+ * the nearest enemy. A session whose game ends starts a new one. Every
+ * turn also prints the stats and board, as a server would to send them,
+ * unless --no-render is given. Printing goes to a null sink, which still
+ * formats every line; with --silent the game's output has no sink at all
+ * and printing returns before formatting anything (output.hpp).
+ *
+ * With --events, the game's events (events.hpp) are recorded as JSON Lines
+ * into a stream that takes US microseconds (0 unless --sink-delay is
+ * given) for every write, like a slow disk or terminal: written by the
+ * game thread itself when the ring fills (sync) or by the background
+ * writer thread (async).
+ *
+ * Reports the turns per second of all sessions together, the CPU time per
+ * turn, the latency of single turns (percentiles) and the memory each
+ * session takes, so the number of games one machine can host can be sized.
+ *
+ * @author [Ish Soundankar]
+ */
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <ctime>
+#include <cstdlib>
+#include <thread>
+#include <algorithm>
+#include <game.hpp>
+#include <board.hpp>
+#include <random.hpp>
+#include <nullsink.hpp>
+#include <events.hpp>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fstream>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/**
+ * @struct LoadSession
+ * @brief One hosted game and the script playing it
+ */
+struct LoadSession {
+    GameSession game;       ///< Game being played
+    GameRandom random;      ///< The game's own random state (swapped in for its turns)
+    GameRandom script;      ///< Choices of the scripted player
+    bool greedy = false;    ///< Greedy player instead of a random walker
+    Position lastPickUp = {-1, -1};  ///< Square the greedy player last tried to pick up on
+    long long games = 0;    ///< Games started
+};
+
+/**
+ * @class SlowSink
+ * @brief Stream buffer that throws its output away, taking a while for each write
+ */
+class SlowSink : public streambuf {
+public:
+    chrono::microseconds delay;  ///< Time each write takes
+    long long writes = 0;        ///< Writes so far
+
+    /**
+     * @brief Constructor
+     *
+     * @param microseconds Time each write takes
+     */
+    SlowSink(int microseconds) : delay(microseconds) {}
+
+protected:
+    int_type overflow(int_type c) override {
+        wait();
+        return traits_type::not_eof(c);
+    }
+    streamsize xsputn(const char*, streamsize n) override {
+        wait();
+        return n;
+    }
+
+private:
+    void wait() {
+        writes++;
+        if (delay.count() > 0) this_thread::sleep_for(delay);
+    }
+};
+
+/**
+ * @brief Resident memory of the process in bytes (0 if unknown)
+ */
+static size_t residentMemory() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.WorkingSetSize;
+    }
+    return 0;
+#else
+    ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    if (!(statm >> pages >> resident)) return 0;
+    return resident * (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+/**
+ * @brief Start a new game in a session
+ *
+ * @param session Session to (re)start
+ * @param setup Start-up answers (the race is varied per game)
+ * @param id Session number, mixed into the random seed
+ */
+static void startGame(LoadSession& session, GameSetup setup, int id) {
+    setup.race = (int)((id + session.games) % 5) + 1;
+    gameRandom().state = ((uint64_t)id << 32) + (uint64_t)session.games;
+    newGame(session.game, setup);
+    session.game.board->updateFieldOfView({session.game.playerRow, session.game.playerColumn});
+    session.random = gameRandom();
+    session.games++;
+}
+
+/**
+ * @brief Next command of a session's scripted player
+ *
+ * Pseudo-code:
+ * 1. Random walker: RETURN any of w/a/s/d/g/j
+ * 2. Greedy player:
+ *    a. IF an enemy is on the square: RETURN attack
+ *    b. IF an item is on the square and not tried here yet: RETURN pick up
+ *    c. IF there is an enemy left: RETURN the step towards the nearest one
+ *    d. RETURN a random step
+ */
+static char nextCommand(LoadSession& session) {
+    static const char randomCommands[] = "wasdgj";
+    static const char steps[] = "wasd";
+    if (!session.greedy) return randomCommands[session.script.nextInt(6)];
+
+    GameSession& game = session.game;
+    Position here = {game.playerRow, game.playerColumn};
+    Square& square = game.board->at(here.row, here.column);
+    if (square.enemy) return 'j';
+    if (square.item && (session.lastPickUp.row != here.row || session.lastPickUp.column != here.column)) {
+        session.lastPickUp = here;
+        return 'g';
+    }
+    Position target;
+    if (game.board->enemyIndex.nearest(here, target)) {
+        if (target.row < here.row) return 'w';
+        if (target.row > here.row) return 's';
+        if (target.column < here.column) return 'a';
+        if (target.column > here.column) return 'd';
+    }
+    return steps[session.script.nextInt(4)];
+}
+
+/**
+ * @brief Run the load test
+ *
+ * Pseudo-code:
+ * 1. Read the options
+ * 2. Start every session, measuring the memory they take
+ * 3. IF --events: open the event log on the slow sink (sync or async)
+ * 4. FOR each round of turns: FOR each session:
+ *    a. Swap its random state in, play its scripted command, swap it out,
+ *       timing the turn
+ *    b. Print its stats and board (unless --no-render), to a null sink or,
+ *       with --silent, to none
+ *    c. IF its game ended: start a new one
+ * 5. Close the event log (waiting for the writer thread to catch up)
+ * 6. Report turns per second, CPU time per turn, turn latency percentiles
+ *    and memory per session
+ *
+ * @param argc Argument count
+ * @param argv Arguments
+ * @return int Exit code (0 for success)
+ */
+int main(int argc, char* argv[]) {
+    int sessionCount = 100;
+    long long turns = 10000;
+    bool render = true;
+    string players = "mixed";
+    string events;
+    int sinkDelay = 0;
+    bool silent = false;
+    GameSetup setup;
+    setup.length = 64;
+    setup.breadth = 64;
+    setup.name = "Load";
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--sessions" && i + 1 < argc) {
+            sessionCount = atoi(argv[++i]);
+        } else if (option == "--turns" && i + 1 < argc) {
+            turns = atoll(argv[++i]);
+        } else if (option == "--size" && i + 1 < argc) {
+            setup.length = setup.breadth = atoi(argv[++i]);
+        } else if (option == "--endless") {
+            setup.endless = true;
+        } else if (option == "--players" && i + 1 < argc) {
+            players = argv[++i];
+        } else if (option == "--no-render") {
+            render = false;
+        } else if (option == "--events" && i + 1 < argc) {
+            events = argv[++i];
+        } else if (option == "--sink-delay" && i + 1 < argc) {
+            sinkDelay = atoi(argv[++i]);
+        } else if (option == "--silent") {
+            silent = true;
+        } else {
+            cout << "Usage: loadtest [--sessions N] [--turns T] [--size S | --endless]"
+                    " [--players random|greedy|mixed] [--no-render]"
+                    " [--events sync|async] [--sink-delay US] [--silent]" << endl;
+            return 1;
+        }
+    }
+    if (sessionCount < 1 || turns < 1 || setup.length < 1 || sinkDelay < 0 ||
+        (players != "random" && players != "greedy" && players != "mixed") ||
+        (!events.empty() && events != "sync" && events != "async")) {
+        cout << "Sessions, turns and size must be positive, players random, greedy or mixed,"
+                " events sync or async." << endl;
+        return 1;
+    }
+
+    size_t memoryBefore = residentMemory();
+    vector<LoadSession> sessions(sessionCount);
+    {
+        QuietOutput quiet;
+        for (int id = 0; id < sessionCount; id++) {
+            LoadSession& session = sessions[id];
+            session.greedy = players == "greedy" || (players == "mixed" && id % 2 == 1);
+            session.script = GameRandom((uint64_t)id * 7919 + 1);
+            setup.worldSeed = (unsigned)id;
+            startGame(session, setup, id);
+        }
+    }
+    size_t memoryStarted = residentMemory();
+
+    SlowSink eventSink(sinkDelay);
+    ostream eventStream(&eventSink);
+    if (!events.empty()) gameEvents().open(eventStream, EVENTS_JSONL, events == "async");
+
+    vector<float> latencies;
+    latencies.reserve((size_t)turns * sessionCount);
+    long long played = 0;
+    auto wallStart = chrono::steady_clock::now();
+    clock_t cpuStart = clock();
+    {
+        NullSink discard;
+        RedirectOutput quiet(silent ? nullptr : &discard);
+        istringstream noAnswers;
+        for (long long round = 0; round < turns; round++) {
+            for (int id = 0; id < sessionCount; id++) {
+                LoadSession& session = sessions[id];
+                GameSession& game = session.game;
+                char command = nextCommand(session);
+                auto turnStart = chrono::steady_clock::now();
+                gameRandom() = session.random;
+                TurnInput input(noAnswers);
+                playTurn(game, command, input);
+                session.random = gameRandom();
+                latencies.push_back(chrono::duration<float, micro>(chrono::steady_clock::now() - turnStart).count());
+                played++;
+                if (render) {
+                    currentStats(game.playerRow, game.playerColumn, game.player, game.gold);
+                    game.board->printBoard({game.playerRow, game.playerColumn});
+                }
+                if (game.gameOver) startGame(session, setup, id);
+            }
+        }
+    }
+    double cpuSeconds = (double)(clock() - cpuStart) / CLOCKS_PER_SEC;
+    double wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - wallStart).count();
+    size_t memoryEnd = residentMemory();
+    uint64_t fullWaits = gameEvents().writer ? gameEvents().writer->fullWaits : 0;
+    auto closeStart = chrono::steady_clock::now();
+    gameEvents().close();
+    double closeSeconds = chrono::duration<double>(chrono::steady_clock::now() - closeStart).count();
+
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) { return latencies[(size_t)(p * (double)(latencies.size() - 1))]; };
+
+    long long games = 0;
+    size_t boardBytes = 0;
+    for (const LoadSession& session : sessions) {
+        games += session.games;
+        boardBytes += session.game.board->residentBytes;
+    }
+
+    cout << "Sessions: " << sessionCount << " (" << players << " players, "
+         << (setup.endless ? string("endless") : to_string(setup.length) + "x" + to_string(setup.breadth))
+         << (render ? "" : ", not rendered") << (silent ? ", silent" : "") << ")" << endl;
+    cout << "Turns: " << played << " in " << games << " games, " << wallSeconds << " s" << endl;
+    cout << "Turns/s: " << (long long)(played / wallSeconds) << " ("
+         << (long long)(played / wallSeconds / sessionCount) << " per session)" << endl;
+    cout << "CPU per turn: " << cpuSeconds * 1e6 / played << " us" << endl;
+    cout << "Turn latency: p50 " << percentile(0.5) << " us, p99 " << percentile(0.99)
+         << " us, p99.9 " << percentile(0.999) << " us, p99.99 " << percentile(0.9999)
+         << " us, max " << latencies.back() << " us" << endl;
+    if (!events.empty()) {
+        cout << "Events: " << events << ", " << eventSink.writes << " writes of "
+             << sinkDelay << " us; " << fullWaits << " waits for a full ring, "
+             << closeSeconds * 1000 << " ms to drain at the end" << endl;
+    }
+    if (memoryBefore > 0) {
+        cout << "Memory per session: " << (memoryStarted - memoryBefore) / sessionCount / 1024
+             << " KiB at start, " << (memoryEnd > memoryBefore ? (memoryEnd - memoryBefore) / sessionCount / 1024 : 0)
+             << " KiB at end (resident set)" << endl;
+    }
+    cout << "Board chunks per session: " << boardBytes / sessionCount / 1024 << " KiB" << endl;
+    return 0;
+}
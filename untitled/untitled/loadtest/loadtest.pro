@@ -0,0 +1,32 @@
+# Headless load test: many game sessions in one process, played by
+# scripted players (see loadtest.cpp for the options).
+#
+#   qmake loadtest.pro && make && ./loadtest --sessions 500 --turns 2000
+
+TEMPLATE = app
+TARGET = loadtest
+CONFIG += console c++17 release thread
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += ..
+
+SOURCES += \
+        loadtest.cpp \
+        ../board.cpp \
+        ../characters.cpp \
+        ../counters.cpp \
+        ../events.cpp \
+        ../game.cpp \
+        ../interned.cpp \
+        ../journal.cpp \
+        ../keyboard.cpp \
+        ../pager.cpp \
+        ../serialize.cpp \
+        ../snapshot.cpp \
+        ../spatial.cpp \
+        ../spawn.cpp \
+        ../terrain.cpp \
+        ../timing.cpp
+
+win32: LIBS += -lpsapi
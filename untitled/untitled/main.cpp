@@ -2,9 +2,10 @@
  * @file main.cpp
  * @brief Main game loop and user interface
  *
- * This file contains the main game loop, combat system, and user command
- * processing for the text-based adventure game. It handles player movement,
- * combat, inventory management, and the day/night cycle.
+ * This file contains the main game loop and user interface for the
+ * text-based adventure game. It sets the game up, reads commands and prints
+ * the board; the commands themselves (movement, combat, inventory and the
+ * day/night cycle) are applied by playTurn() in game.cpp.
  *
  * @author [Ish Soundankar]
  */
@@ -15,70 +16,45 @@
 #include <characters.hpp>
 #include <items.hpp>
 #include <board.hpp>
+#include <game.hpp>
+#include <snapshot.hpp>
+#include <journal.hpp>
+#include <keyboard.hpp>
+#include <timing.hpp>
+#include <counters.hpp>
+#include <random.hpp>
+#include <nullsink.hpp>
+#include <events.hpp>
 #include <stdlib.h>
+#include <ctime>
+#include <chrono>
+#include <climits>
+#include <cctype>
+#include <cstring>
 using namespace std;
 
-/**
- * @brief Handle combat between two characters
- *
- * Pseudo-code:
- * 1. Display attack message
- * 2. Generate random attack roll (0.0 to 1.0)
- * 3. IF attack roll > attacker's attack chance:
- *    a. Display miss message
- *    b. RETURN (attack failed)
- * 4. Generate random defense roll (0.0 to 1.0)
- * 5. IF defense roll < defender's defense chance:
- *    a. Call defender's successfulDef() method (race-specific)
- *    b. RETURN (attack blocked)
- * 6. Calculate damage = attacker total attack - defender total defense
- * 7. IF damage > 0:
- *    a. Subtract damage from defender health
- *    b. IF health < 0: set health to 0
- *    c. Display damage message
- *    d. IF health > max health: set health to max health
- * 8. ELSE: display block message
- * 9. IF defender health <= 0: display defeat message
- *
- * @param attacker Character initiating the attack
- * @param defender Character being attacked
- */
-void attack(Character* attacker, Character* defender) {
-    cout << attacker->name << " attacks " << defender->name << endl;
-    float attackRoll = (float)rand() / RAND_MAX;
-    if (attackRoll > attacker->attack_chance) {
-        cout << attacker->name << " missed!" << endl;
-        return;
-    }
-    float defenceRoll = (float)rand() / RAND_MAX;
-    if (defenceRoll < defender->defence_chance) {
-        defender->successfulDef(attacker, defender);
-        return;
-    }
+// Bytes of board chunks kept in memory before cold ones are paged to disk
+const size_t BOARD_MEMORY_BUDGET = 256u << 20;
 
-    if (attacker->getTotalAttack() > defender->getTotalDefence()) {
-        int damage = attacker->getTotalAttack() - defender->getTotalDefence();
-        defender->health -= damage;
-        if (defender->health < 0) defender->health = 0;
-        cout << defender->name << " takes " << damage << " hits of damage" << endl;
-        cout << defender->name << " health: " << defender->getTotalHealth() << endl;
-        if (defender->health > defender->getTotalHealth()) {
-            defender->health = defender->getTotalHealth();
-        }
-    } else {
-        cout << defender->name << " blocked the attack" << endl;
-    }
-    if (defender->getTotalHealth() <= 0) {
-        cout << defender->name << " defeated" << endl;
-    }
-}
-
-// Global player and enemy character pointers
-shared_ptr<Character> player;
+// Global enemy character pointer
 shared_ptr<Character> enemy;
 
+// Milliseconds the loop waits for a key before doing idle work
+const int IDLE_TICK_MS = 250;
+
+// Turns typed ahead without an idle tick before paging is done anyway
+const int TRIM_EVERY_TURNS = 64;
+
+// File the 'v' command saves to and start-up option 3 loads from
+const string SAVE_FILE = "savegame.bin";
+
+// Turn journal and the prefix of its checkpoint files, used by start-up
+// option 4 after a crash and by --replay
+const string JOURNAL_FILE = "savegame.journal";
+const string CHECKPOINT_FILE = "savegame.checkpoint";
+
 /**
- * @brief Create and configure the player character
+ * @brief Ask for the player's name and race
  *
  * Pseudo-code:
  * 1. Create temporary instances of each race to display stats
@@ -86,14 +62,16 @@ shared_ptr<Character> enemy;
  * 3. WHILE valid choice is false:
  *    a. Display race selection menu with stats
  *    b. Get race choice from user
- *    c. SWITCH on choice:
- *       - Case 1-5: Create appropriate race character, set validChoice = true
- *       - Default: Display error, clear input buffer
- * 4. Clear screen and display selected character stats
+ *    c. IF choice is 1-5: store it, set validChoice = true
+ *       ELSE: Display error, clear input buffer
+ * 4. Clear screen
+ *
+ * The player itself is created by newGame() from the answers, so a replay
+ * of the game creates the same player.
  *
- * @param player Reference to the player character pointer to be set
+ * @param setup Start-up answers; name and race are filled in
  */
-void user(shared_ptr<Character>& player) {
+void user(GameSetup& setup) {
     int choice;
     Human tempHuman("Human");
     Elf tempElf("Elf");
@@ -101,389 +79,465 @@ void user(shared_ptr<Character>& player) {
     Hobbit tempHobbit("Hobbit");
     Orc tempOrc("Orc");
 
-    string userName;
-    cout << "Enter Name: " << endl;
-    cin >> userName;
+    gameOut() << "Enter Name: " << endl;
+    cin >> setup.name;
 
     bool validChoice = false;
     while (!validChoice) {
-        cout << "Select race of player: " << endl;
-        cout << "1." << endl;
+        gameOut() << "Select race of player: " << endl;
+        gameOut() << "1." << endl;
         tempHuman.printStats();
-        cout << "2." << endl;
+        gameOut() << "2." << endl;
         tempElf.printStats();
-        cout << "3." << endl;
+        gameOut() << "3." << endl;
         tempDwarf.printStats();
-        cout << "4." << endl;
+        gameOut() << "4." << endl;
         tempHobbit.printStats();
-        cout << "5." << endl;
+        gameOut() << "5." << endl;
         tempOrc.printStats();
 
-        cout << "Enter your choice (1-5): " << endl;
+        gameOut() << "Enter your choice (1-5): " << endl;
         cin >> choice;
 
-        switch (choice) {
-        case 1:
-            player = make_shared<Human>(userName);
-            validChoice = true;
-            break;
-        case 2:
-            player = make_shared<Elf>(userName);
-            validChoice = true;
-            break;
-        case 3:
-            player = make_shared<Dwarf>(userName);
-            validChoice = true;
-            break;
-        case 4:
-            player = make_shared<Hobbit>(userName);
+        if (choice >= 1 && choice <= 5) {
+            setup.race = choice;
             validChoice = true;
-            break;
-        case 5:
-            player = make_shared<Orc>(userName);
-            validChoice = true;
-            break;
-        default:
-            cout << "Invalid Choice! Please enter a number between 1 and 5." << endl;
+        } else {
+            gameOut() << "Invalid Choice! Please enter a number between 1 and 5." << endl;
             cin.clear();
             cin.ignore(10000, '\n');
-            break;
         }
     }
     system("cls");
-    cout << "You selected: ";
-    player->printStats();
 }
 
 /**
- * @brief Display current game state information
+ * @brief Print the phase timings and/or counters of an instrumented build
+ */
+void printInstrumentation() {
+#ifdef GAME_TIMING
+    turnTimings().report(cout);
+#endif
+#ifdef GAME_COUNTERS
+    turnCounters.report(cout);
+#endif
+}
+
+#ifdef GAME_COUNTERS
+/**
+ * @class CyclingAnswers
+ * @brief Stream buffer that hands out the same answers over and over
+ *
+ * Answers the follow-up prompts of scripted turns without ever running out.
+ */
+class CyclingAnswers : public streambuf {
+public:
+    const char* text;  ///< Answers, separated by spaces
+    size_t length;     ///< Characters in text
+
+    /**
+     * @brief Constructor
+     *
+     * @param answers Answers, separated by spaces
+     */
+    CyclingAnswers(const char* answers) : text(answers), length(strlen(answers)) {}
+
+protected:
+    int_type underflow() override {
+        char* start = const_cast<char*>(text);
+        setg(start, start, start + length);
+        return traits_type::to_int_type(*start);
+    }
+};
+
+/**
+ * @brief Check that the turn loop does not allocate once warmed up (--self-check)
+ *
+ * Usage: untitled --self-check [turns]   (counter builds only)
+ *
+ * Pseudo-code:
+ * 1. Start a game on a 64x64 board with a fixed seed and a journal in a
+ *    temporary file, with everything printed thrown away
+ * 2. FOR turns (1,000,000 unless given) scripted commands:
+ *    a. IF the game is new: play WARM_UP turns without counting, so the
+ *       buffers the loop reuses reach their working size
+ *    b. Play the turn, journal it, print the stats and board
+ *    c. IF the game ended: start a new one
+ * 3. Report the allocations counted, with the per-phase table
+ * 4. RETURN 0 if there were none, otherwise 1
  *
- * @param playerRow Current row position of player on board
- * @param playerColumn Current column position of player on board
- * @param player Pointer to player character
- * @param gold Current amount of gold collected
+ * @param argc Argument count from main()
+ * @param argv Arguments from main()
+ * @return int Exit code (0 if the counted turns made no allocations)
  */
-void currentStats(int playerRow, int playerColumn, shared_ptr<Character> player, int gold) {
-    cout << "Current location: " << playerRow << " " << playerColumn << endl;
-    player->printStats();
-    cout << "Gold: " << gold << endl;
+int selfCheck(int argc, char* argv[]) {
+    const int WARM_UP = 2000;
+    const char* SCRIPT = "wasdwasdgjjklnfh";
+    long long turns = argc > 2 ? atoll(argv[2]) : 1000000;
+    const string journalPath = "selfcheck.journal";
+    const string checkpointPath = "selfcheck.checkpoint";
+
+    QuietOutput quiet;
+    CyclingAnswers answers("w 0 a 0 s 0 r 0 x 9 ");
+    istream answerStream(&answers);
+    GameRandom script(2);
+    GameSetup setup;
+    setup.length = 64;
+    setup.breadth = 64;
+    setup.name = "Check";
+    GameSession session;
+    Journal journal(journalPath, checkpointPath);
+    journal.checkpointInterval = 0;
+    long long games = 0;
+    long long counted = 0;
+
+    turnCounters = TurnCounters();
+    turnCounters.paused = true;
+    for (long long played = 0; played < turns; ) {
+        if (session.gameOver || !session.board) {
+            turnCounters.paused = true;
+            journal.close();
+            gameRandom().state = (uint64_t)games;
+            setup.race = (int)(games % 5) + 1;
+            newGame(session, setup);
+            journal.start(session, (uint64_t)games, &setup);
+            games++;
+        }
+        turnCounters.paused = session.turn < WARM_UP;
+        char choice = SCRIPT[script.nextInt((int)strlen(SCRIPT))];
+        TurnInput input(answerStream);
+        playTurn(session, choice, input);
+        {
+            TIME_PHASE(PHASE_JOURNAL);
+            journal.append(session, choice, input.record);
+        }
+        {
+            TIME_PHASE(PHASE_STATS);
+            currentStats(session.playerRow, session.playerColumn, session.player, session.gold);
+        }
+        {
+            TIME_PHASE(PHASE_RENDER);
+            session.board->printBoard({session.playerRow, session.playerColumn});
+        }
+        if (!turnCounters.paused) {
+            counted++;
+            played++;
+        }
+    }
+    turnCounters.paused = true;
+    journal.close();
+    remove(journalPath.c_str());
+    remove(checkpointFileName(checkpointPath, 0).c_str());
+
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    for (const PhaseCounts& counts : turnCounters.phases) {
+        allocations += counts.allocations;
+        bytes += counts.bytes;
+    }
+    cout << "Self-check: " << counted << " turns in " << games << " games, "
+         << allocations << " allocations (" << bytes << " bytes) after warm-up" << endl;
+    turnCounters.report(cout);
+    return allocations == 0 ? 0 : 1;
+}
+#endif
+
+/**
+ * @brief Replay a journalled game without playing it (--replay)
+ *
+ * Usage: untitled --replay [journal] [--to N] [--events FILE | --events-binary FILE]
+ *
+ * Pseudo-code:
+ * 1. Read the journal (savegame.journal unless another file is given)
+ * 2. Replay it up to turn N (or to its end) without printing, timing it
+ * 3. Report the turns played, turns per second and the session digest,
+ *    and whether every checkpoint passed matched the recorded game
+ * 4. Print the stats and board at the turn reached
+ *
+ * @param argc Argument count from main()
+ * @param argv Arguments from main()
+ * @return int Exit code (0 if the replay matched the recorded game)
+ */
+int replay(int argc, char* argv[]) {
+    string path = JOURNAL_FILE;
+    int toTurn = INT_MAX;
+    for (int i = 2; i < argc; i++) {
+        string argument = argv[i];
+        if (argument == "--to" && i + 1 < argc) {
+            toTurn = atoi(argv[++i]);
+        } else if ((argument == "--events" || argument == "--events-binary") && i + 1 < argc) {
+            i++;  // Opened by main()
+        } else {
+            path = argument;
+        }
+    }
+
+    JournalContents contents;
+    if (!readJournal(path, contents)) {
+        cout << "Cannot read journal " << path << endl;
+        return 1;
+    }
+    GameSession session;
+    ReplayResult result;
+    auto begin = chrono::steady_clock::now();
+    if (!replayJournal(contents, CHECKPOINT_FILE, toTurn, session, result)) {
+        cout << "The game's first checkpoint is missing, cannot replay it." << endl;
+        return 1;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    cout << "Replayed turns " << result.startTurn << " to " << session.turn
+         << " (" << result.turnsPlayed << " turns) in " << seconds * 1000 << " ms";
+    if (seconds > 0) cout << ", " << (long long)(result.turnsPlayed / seconds) << " turns/s";
+    cout << endl;
+    cout << "Session digest: " << hex << sessionDigest(session) << dec << endl;
+    if (result.mismatchTurn >= 0) {
+        cout << "Replay differs from the recorded game at turn " << result.mismatchTurn << endl;
+    } else {
+        cout << "Checkpoints matched: " << result.checkpointsChecked << endl;
+    }
+
+    session.board->updateFieldOfView({session.playerRow, session.playerColumn});
+    currentStats(session.playerRow, session.playerColumn, session.player, session.gold);
+    session.board->printBoard({session.playerRow, session.playerColumn});
+    return result.mismatchTurn >= 0 ? 1 : 0;
 }
 
 /**
  * @brief Main game loop
  *
  * Pseudo-code:
- * 1. Initialize game variables (command count, day/night, enemies, items, board)
- * 2. Create player character
- * 3. WHILE game not over:
- *    a. Display command prompt
- *    b. Get user command
+ * 1. Initialize game variables (command count, day/night, enemies, items, board);
+ *    the board is either populated with the enemies/items, an endless world,
+ *    a bounded board of any size generated from a seed, or restored with
+ *    the rest of the session from the save file or from the journal of an
+ *    interrupted game
+ * 2. Ask for the player's name and race and set up the new game (unless the
+ *    game was loaded)
+ * 3. Start the journal (or keep appending to it after a recovery)
+ * 4. Switch the keyboard to single keypresses
+ * 5. WHILE game not over:
+ *    a. Display command prompt (once per turn)
+ *    b. Wait up to IDLE_TICK_MS for a key
+ *       - Input closed: stop
+ *       - No key (idle tick): page cold board chunks out if over the memory
+ *         budget, then keep waiting
+ *       - Space or newline: ignore it
  *    c. Clear screen
- *    d. Remove player from current square
- *    e. SWITCH on command:
- *       - Movement (w/a/s/d): Update position, check square content
- *       - Pickup (g): Attempt to pick up item
- *       - Attack (j): Combat with enemy on square
- *       - Drop (h): Drop equipped item
- *       - Look (k): Display square information
- *       - Inventory (l): Display player inventory
- *       - Exit (x): Set gameOver = true
- *    f. Update day/night cycle if needed
- *    g. Place player on new square
- *    h. Display current stats and board
- * 4. RETURN 0
+ *    d. FOR the key and every key already typed ahead after it:
+ *       - Save (v): write the session to the save file
+ *       - Report (t, timing and counter builds only): print the phase
+ *         histograms and allocation counts
+ *       - Otherwise: play the turn (see playTurn()), append it to the journal,
+ *         and page out if TRIM_EVERY_TURNS turns passed without an idle tick
+ *       - Stop early if the game ended
+ *    e. Display current stats and board once for the whole batch
+ *    Each phase is timed when the game is built with GAME_TIMING, and its
+ *    allocations and shared_ptr copies are counted with GAME_COUNTERS; the
+ *    reports are printed on exit
+ * 6. RETURN 0
+ *
+ * Started with --replay, replays a journalled game instead (see replay());
+ * counter builds started with --self-check check that the turn loop does
+ * not allocate (see selfCheck()). With --events FILE (JSON Lines) or
+ * --events-binary FILE, the game's events (see events.hpp) are written to
+ * FILE by a background writer thread, whether the game is played or replayed.
  *
+ * @param argc Argument count
+ * @param argv Arguments
  * @return int Exit code (0 for success)
  */
-int main() {
-    int commandCount = 0;
-    bool isNight = false;
-    int length = 12;
-    int breadth = 12;
+int main(int argc, char* argv[]) {
+#ifdef GAME_COUNTERS
+    countThisThread();
+#endif
+    for (int i = 1; i + 1 < argc; i++) {
+        string argument = argv[i];
+        if (argument == "--events" || argument == "--events-binary") {
+            EventFormat format = argument == "--events" ? EVENTS_JSONL : EVENTS_BINARY;
+            if (!gameEvents().openFile(argv[++i], format, true)) {
+                cout << "Cannot create event file " << argv[i] << endl;
+                return 1;
+            }
+        }
+    }
+    if (argc > 1 && string(argv[1]) == "--replay") {
+        int result = replay(argc, argv);
+        gameEvents().close();
+        return result;
+    }
+#ifdef GAME_COUNTERS
+    if (argc > 1 && string(argv[1]) == "--self-check") {
+        return selfCheck(argc, argv);
+    }
+#endif
+
+    ios::sync_with_stdio(false);  // Lets KeyboardInput see what cin has buffered
+    cin.tie(&gameOut());  // Show prompts before waiting for the start-up answers
+    GameSession session;
+    GameSetup setup;
     char changeParameter;    // Start as day
 
-    vector<shared_ptr<Character>> enemies;
-    enemies.push_back(make_shared<Human>("Bob"));
-    enemies.push_back(make_shared<Elf>("Legolas"));
-    enemies.push_back(make_shared<Dwarf>("Gimli"));
-    enemies.push_back(make_shared<Hobbit>("Frodo"));
-    enemies.push_back(make_shared<Orc>("Azog"));
-
-    vector<shared_ptr<Item>> items;
-    items.push_back(Sword);
-    items.push_back(Dagger);
-    items.push_back(LeatherArmor);
-    items.push_back(PlateArmor);
-    items.push_back(RingOfLife);
-    items.push_back(RingOfStrength);
-
-    cout << "Default length and breadth of grid is 12. Press 1 to change parameters.\nPress any key to continue\nPress (1) to change parameters"<<endl;
+    gameOut() << "Default length and breadth of grid is 12. Press 1 to change parameters.\nPress any key to continue\nPress (1) to change parameters\nPress (2) to explore an endless world\nPress (3) to load the saved game\nPress (4) to recover a game that was interrupted\nPress (5) to generate a world of any size from a seed"<<endl;
     cin >> changeParameter;
     if(changeParameter == '1'){
-        cout << "Enter length: ";
-        cin >> length;
-        cout << "Enter breadth: ";
-        cin >> breadth;
-        cout << endl;
+        gameOut() << "Enter length: ";
+        cin >> setup.length;
+        gameOut() << "Enter breadth: ";
+        cin >> setup.breadth;
+        gameOut() << endl;
+    }
+    if(changeParameter == '2'){
+        setup.endless = true;
+        gameOut() << "Enter world seed: ";
+        cin >> setup.worldSeed;
+        gameOut() << endl;
+    }
+    if(changeParameter == '5'){
+        setup.generated = true;
+        gameOut() << "Enter length: ";
+        cin >> setup.length;
+        gameOut() << "Enter breadth: ";
+        cin >> setup.breadth;
+        gameOut() << "Enter world seed: ";
+        cin >> setup.worldSeed;
+        gameOut() << endl;
     }
     system("cls");
-    Board board(length, breadth);
-    board.populateBoard(enemies, items);
-    user(player);
-    system("cls");
-    player->printStats();
-    int playerRow = 0;
-    int playerColumn = 0;
-    int gold = 0;
-
-    char choice;
-    bool gameOver = false;
-
-    while (!gameOver) {
-
-        cout << "Enter command (w/a/s/d = move, g = pickup, j = attack, h = drop, k = look, l = inventory, x = exit): " << endl;
-        if(isNight == true){
-            cout<< "Current Time: Night"<<endl;
+    uint64_t startSeed = (uint64_t)time(nullptr);
+    gameRandom().state = startSeed;
+    Journal journal(JOURNAL_FILE, CHECKPOINT_FILE);
+    bool loaded = false;
+    bool recovered = false;
+    if (changeParameter == '4') {
+        recovered = recoverSession(journal, session);
+        loaded = recovered;
+        if (!recovered) {
+            gameOut() << "No interrupted game to recover, starting a new one." << endl;
+            session = GameSession();
+            gameRandom().state = startSeed;
         }
-        else{
-            cout << "Current Time: Day"<<endl;
+    }
+    if (changeParameter == '3') {
+        loaded = loadSnapshot(SAVE_FILE, session);
+        if (!loaded) {
+            gameOut() << "No usable saved game found, starting a new one." << endl;
         }
-        cin >> choice;
-        system("cls");
-
-        board.grid[playerRow][playerColumn]->player = nullptr;
-
-        switch (choice) {
-        case 'w':
-            cout << "moving up" << endl;
-            if (playerRow > 0) {
-                playerRow--;
-                auto& currentSquare = board.grid[playerRow][playerColumn];
-                if (currentSquare->enemy) {
-                    cout << "\n*** You've encountered an enemy! ***" << endl;
-                    currentSquare->enemy->printStats();
-                }
-                if (currentSquare->item) {
-                    cout << "\n*** You've found an item! ***" << endl;
-                    currentSquare->item->print();
-                }
-            } else {
-                cout << "Cannot move up! You're at the top edge of the board." << endl;
+    }
+    if (!loaded) {
+        user(setup);
+        newGame(session, setup);
+        gameOut() << "You selected: ";
+        session.player->printStats();
+    }
+    Board& board = *session.board;
+    board.memoryBudget = BOARD_MEMORY_BUDGET;
+    session.player->printStats();
+
+    if (!recovered && !journal.start(session, startSeed, loaded ? nullptr : &setup)) {
+        gameOut() << "Could not open the journal, this game cannot be recovered after a crash." << endl;
+    }
+
+    // Keys are read one at a time from here on; cin is left in line mode
+    // for the start-up questions above
+    KeyboardInput keyboard;
+    KeyStreamBuffer keyBuffer(keyboard);
+    istream keys(&keyBuffer);
+    keys.tie(&gameOut());  // Show prompts printed without endl before waiting for the answer
+    keyboard.begin();
+
+    bool showPrompt = true;
+    int turnsSinceIdle = 0;
+    while (!session.gameOver) {
+        if (showPrompt) {
+            gameOut() << "Enter command (w/a/s/d = move, g = pickup, j = attack, h = drop, k = look, l = inventory, n = nearest, f = fog of war, v = save, x = exit): " << endl;
+            if(session.isNight == true){
+                gameOut()<< "Current Time: Night"<<endl;
             }
-            commandCount++;
-            break;
-
-        case 's':
-            cout << "moving down" << endl;
-            if (playerRow < 11) {
-                playerRow++;
-                auto& currentSquare = board.grid[playerRow][playerColumn];
-                if (currentSquare->enemy) {
-                    cout << "\n*** You've encountered an enemy! ***" << endl;
-                    currentSquare->enemy->printStats();
-                }
-                if (currentSquare->item) {
-                    cout << "\n*** You've found an item! ***" << endl;
-                    currentSquare->item->print();
-                }
-            } else {
-                cout << "Cannot move down! You're at the bottom edge of the board." << endl;
+            else{
+                gameOut() << "Current Time: Day"<<endl;
             }
-            commandCount++;
-            break;
-
-        case 'a':
-            cout << "moving left" << endl;
-            if (playerColumn > 0) {
-                playerColumn--;
-                auto& currentSquare = board.grid[playerRow][playerColumn];
-                if (currentSquare->enemy) {
-                    cout << "\n*** You've encountered an enemy! ***" << endl;
-                    currentSquare->enemy->printStats();
-                }
-                if (currentSquare->item) {
-                    cout << "\n*** You've found an item! ***" << endl;
-                    currentSquare->item->print();
-                }
-            } else {
-                cout << "Cannot move left! You're at the left edge of the board." << endl;
-            }
-            commandCount++;
-            break;
-
-        case 'd':
-            cout << "moving right" << endl;
-            if (playerColumn < 11) {
-                playerColumn++;
-                auto& currentSquare = board.grid[playerRow][playerColumn];
-                if (currentSquare->enemy) {
-                    cout << "\n*** You've encountered an enemy! ***" << endl;
-                    currentSquare->enemy->printStats();
-                }
-                if (currentSquare->item) {
-                    cout << "\n*** You've found an item! ***" << endl;
-                    currentSquare->item->print();
-                }
-            } else {
-                cout << "Cannot move right! You're at the right edge of the board." << endl;
+            showPrompt = false;
+        }
+
+        int key = keyboard.readKey(IDLE_TICK_MS);
+        if (key == KEY_CLOSED) break;  // Input closed: stop without journaling more turns
+        if (key == KEY_TIMEOUT) {
+            // Idle tick: do the paging work while the player is thinking
+            TIME_PHASE(PHASE_PAGING);
+            board.trimMemory({session.playerRow, session.playerColumn});
+            turnsSinceIdle = 0;
+            continue;
+        }
+        if (isspace(key)) continue;
+
+        bool inputClosed = false;
+        {
+            TIME_PHASE(PHASE_BATCH);
+            {
+                TIME_PHASE(PHASE_CLEAR);
+                system("cls");
             }
-            commandCount++;
-            break;
-
-        case 'h':
-            cout << "Drop what? (1=Weapon, 2=Armour, 3=Shield, 4=Ring): ";
-            char slot;
-            cin >> slot;
-            if (slot == '1') {
-                player->dropWeapon();
-            } else if (slot == '2') {
-                player->dropArmour();
-            } else if (slot == '3') {
-                player->dropShield();
-            } else if (slot == '4') {
-                if (player->ring.empty()) {
-                    cout << "No rings to drop." << endl;
-                } else {
-                    cout << "Which ring? ";
-                    for (size_t i = 0; i < player->ring.size(); ++i) {
-                        cout << i+1 << ") " << player->ring[i]->name << "  ";
-                    }
-                    cout << endl;
-                    int rnum;
-                    cin >> rnum;
-                    if (cin.fail() || rnum < 1 || rnum > (int)player->ring.size()) {
-                        cout << "Invalid ring selection! Please enter a number between 1 and " << player->ring.size() << "." << endl;
-                        cin.clear();
-                        cin.ignore(10000, '\n');
+
+            // Apply every command already typed ahead, then draw one frame
+            while (true) {
+                char choice = (char)key;
+                if (isspace(key)) {
+                    // Separators between typed-ahead commands
+                } else if (choice == 'v') {
+                    if (saveSnapshot(SAVE_FILE, session)) {
+                        gameOut() << "Game saved." << endl;
                     } else {
-                        player->dropRing(rnum - 1);
+                        gameOut() << "Could not save the game!" << endl;
                     }
-                }
-            } else {
-                cout << "Invalid choice! Please enter 1, 2, 3, or 4." << endl;
-                cin.clear();
-                cin.ignore(10000, '\n');
-            }
-            commandCount++;
-            break;
-
-        case 'j': {
-            cout << "attack" << endl;
-            auto& enemyOnSquare = board.grid[playerRow][playerColumn]->enemy;
-            player->printStats();
-            if (enemyOnSquare) {
-                enemyOnSquare->printStats();
-                attack(player.get(), enemyOnSquare.get());
-
-                if (enemyOnSquare->getTotalHealth() <= 0) {
-                    cout << enemyOnSquare->race << " Defeated!  Received 20 gold!" << endl;
-                    board.grid[playerRow][playerColumn]->enemy = nullptr;
-                    gold += 20;
-                    bool anyEnemiesLeft = false;
-                    for (int r = 0; r < board.height; ++r) {
-                        for (int c = 0; c < board.width; ++c) {
-                            if (board.grid[r][c]->enemy) {
-                                anyEnemiesLeft = true;
-                                break;
-                            }
-                        }
-                        if (anyEnemiesLeft) break;
+#if defined(GAME_TIMING) || defined(GAME_COUNTERS)
+                } else if (choice == 't') {
+                    printInstrumentation();
+#endif
+                } else {
+                    TurnInput input(keys);
+                    playTurn(session, choice, input);
+                    {
+                        TIME_PHASE(PHASE_JOURNAL);
+                        journal.append(session, choice, input.record);
                     }
-                    if (!anyEnemiesLeft) {
-                        cout << "Congratulations! You defeated all the enemies and won the game!" << endl;
-                        gameOver = true;
+                    if (++turnsSinceIdle >= TRIM_EVERY_TURNS) {
+                        TIME_PHASE(PHASE_PAGING);
+                        board.trimMemory({session.playerRow, session.playerColumn});
+                        turnsSinceIdle = 0;
                     }
-                    break;
                 }
-
-                attack(enemyOnSquare.get(), player.get());
-                if (player->getTotalHealth() <= 0) {
-                    cout << "You Died! \n Game over!" << endl;
-                    gameOver = true;
+                if (session.gameOver) break;
+                {
+                    TIME_PHASE(PHASE_INPUT);
+                    key = keyboard.pending() ? keyboard.readKey(0) : KEY_TIMEOUT;
                 }
-            } else {
-                cout << "No enemy to attack" << endl;
+                if (key == KEY_CLOSED) inputClosed = true;
+                if (key < 0) break;
             }
-            commandCount++;
-            break;
-        }
 
-        case 'k':
-            cout << "Look" << endl;
-            cout << "Information about current square: " << endl;
-            board.grid[playerRow][playerColumn]->printInfo();
-            commandCount++;
-            break;
-
-        case 'l':
-            player->printInventory();
-            cout << "Total gold collected: " << gold << endl;
-            commandCount++;
-            break;
-
-        case 'g': {
-            cout << "pickup";
-            auto& itemOnSquare = board.grid[playerRow][playerColumn]->item;
-            if (itemOnSquare) {
-                if (player->pickUp(itemOnSquare)) {
-                    itemOnSquare = nullptr;
-                }
-            } else {
-                cout << "No item here!" << endl;
+            {
+                TIME_PHASE(PHASE_STATS);
+                currentStats(session.playerRow, session.playerColumn, session.player, session.gold);
             }
-        }
-            commandCount++;
-            break;
-
-        case 'x':
-            cout << "Exit" << endl;
-            gameOver = true;
-            break;
-
-        default:
-            cout << "Invalid command! Please enter one of the following:" << endl;
-            cout << "w/a/s/d = move, g = pickup, j = attack, h = drop, k = look, l = inventory, x = exit" << endl;
-            break;
-        }
-
-        // Day/night cycle logic - switches every 5 commands
-        if (commandCount % 10 < 5) {
-            if (isNight) {
-                isNight = false;
-                cout << "It is now daytime." << endl;
-                for (int r = 0; r < board.height; ++r) {
-                    for (int c = 0; c < board.width; ++c) {
-                        auto enemyPtr = board.grid[r][c]->enemy;
-                        if (enemyPtr) {
-                            Orc* orcPtr = dynamic_cast<Orc*>(enemyPtr.get());
-                            if (orcPtr) {
-                                orcPtr->setTimeOfDay(isNight);
-                            }
-                        }
-                    }
-                }
-            }
-        } else {
-            if (!isNight) {
-                isNight = true;
-                cout << "It is now night." << endl;
-                for (int r = 0; r < board.height; ++r) {
-                    for (int c = 0; c < board.width; ++c) {
-                        auto enemyPtr = board.grid[r][c]->enemy;
-                        if (enemyPtr) {
-                            Orc* orcPtr = dynamic_cast<Orc*>(enemyPtr.get());
-                            if (orcPtr) {
-                                orcPtr->setTimeOfDay(isNight);
-                            }
-                        }
-                    }
-                }
+            {
+                TIME_PHASE(PHASE_RENDER);
+                board.printBoard({session.playerRow, session.playerColumn});
             }
         }
-
-        board.grid[playerRow][playerColumn]->player = player;
-        currentStats(playerRow, playerColumn, player, gold);
-        board.printBoard();
+        if (inputClosed) break;
+        showPrompt = true;
+    }
+    keyboard.end();
+
+    journal.close();
+    gameEvents().close();
+#if defined(GAME_TIMING) || defined(GAME_COUNTERS)
+    printInstrumentation();
+#endif
+    if (board.pageFile.pageOuts > 0) {
+        cout << "Board pages in: " << board.pageFile.pageIns
+             << ", pages out: " << board.pageFile.pageOuts << endl;
     }
 
     return 0;
@@ -0,0 +1,55 @@
+/**
+ * @file nullsink.hpp
+ * @brief Throwing away the game's printing while it runs unattended
+ *
+ * This file contains NullSink, a stream buffer that discards everything
+ * written to it, QuietOutput, which points the game's output (output.hpp)
+ * at one for as long as it exists, and SilentOutput, which points it
+ * nowhere. Under QuietOutput the printing code still runs (formatting,
+ * virtual calls), only the terminal is left out; under SilentOutput it is
+ * skipped as well. Used by the self-check, the benchmarks and the load
+ * tester.
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <iostream>
+#include <streambuf>
+#include "output.hpp"
+
+using namespace std;
+
+/**
+ * @class NullSink
+ * @brief Stream buffer that throws away everything written to it
+ */
+class NullSink : public streambuf {
+protected:
+    int_type overflow(int_type c) override { return traits_type::not_eof(c); }
+    streamsize xsputn(const char*, streamsize n) override { return n; }
+};
+
+/**
+ * @class QuietOutput
+ * @brief Sends the game's text (gameOut()) to a NullSink until destroyed
+ *
+ * The text is still formatted, as it would be for a real terminal.
+ */
+class QuietOutput {
+public:
+    NullSink sink;            ///< Where the game writes meanwhile
+    RedirectOutput redirect;  ///< Points gameOut() at sink (declared after it)
+
+    QuietOutput() : redirect(&sink) {}
+};
+
+/**
+ * @class SilentOutput
+ * @brief Sends the game's text nowhere until destroyed, skipping its formatting too
+ *
+ * For measuring or running game logic on its own.
+ */
+class SilentOutput : public RedirectOutput {
+public:
+    SilentOutput() : RedirectOutput(nullptr) {}
+};
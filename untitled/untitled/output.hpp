@@ -0,0 +1,120 @@
+/**
+ * @file output.hpp
+ * @brief Where the game's text goes
+ *
+ * This file contains GameOutput, the stream every printing function writes
+ * to (gameOut()) instead of cout, and RedirectOutput, which points it at
+ * another sink for as long as it exists. The sink is any stream buffer:
+ * the terminal (cout's, the default), a file, memory, a NullSink
+ * (nullsink.hpp), or none at all. With none the stream is in the bad
+ * state, so every << returns before formatting anything, and the printing
+ * functions that print more than a line (stats, items, boards) check for
+ * it and return straight away: a headless game pays nothing for its text.
+ *
+ * Reports about a run (timings, counters, replay results) are not game
+ * text and still go to cout.
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+
+using namespace std;
+
+/**
+ * @class GameOutput
+ * @brief The game's text stream and the sink it currently writes to
+ */
+class GameOutput {
+public:
+    ostream stream;    ///< What the game prints to
+    filebuf file;      ///< Sink used by toFile()
+    stringbuf memory;  ///< Sink used by toMemory()
+
+    GameOutput() : stream(cout.rdbuf()) {}
+    GameOutput(const GameOutput&) = delete;
+    GameOutput& operator=(const GameOutput&) = delete;
+
+    /**
+     * @brief Write to a stream buffer from now on (nullptr: nowhere, without formatting)
+     *
+     * Flushes the current sink first, and closes the file if it was toFile()'s.
+     */
+    void to(streambuf* sink) {
+        stream.flush();
+        if (stream.rdbuf() == &file && sink != &file) file.close();
+        stream.rdbuf(sink);  // Clears the state, or sets badbit for nullptr
+    }
+
+    /// Write to the terminal (cout's buffer)
+    void toTerminal() { to(cout.rdbuf()); }
+
+    /// Write nowhere, formatting nothing
+    void toNull() { to(nullptr); }
+
+    /// Collect the text in memory (read it with text()), starting empty
+    void toMemory() {
+        to(&memory);
+        memory.str(string());
+    }
+
+    /**
+     * @brief Write to a file (replacing it)
+     *
+     * @return false if the file could not be created (the sink is unchanged)
+     */
+    bool toFile(const string& path) {
+        stream.flush();
+        if (stream.rdbuf() == &file) file.close();
+        if (!file.open(path, ios::out | ios::trunc | ios::binary)) return false;
+        stream.rdbuf(&file);
+        return true;
+    }
+
+    /// Text collected since toMemory()
+    string text() const { return memory.str(); }
+
+    /// Current sink (nullptr when writing nowhere)
+    streambuf* sink() const { return stream.rdbuf(); }
+
+    /// Whether text is written anywhere (printing functions skip their work if not)
+    bool enabled() const { return stream.rdbuf() != nullptr; }
+};
+
+/**
+ * @brief The game's output (to the terminal until redirected)
+ */
+inline GameOutput& gameOutput() {
+    static GameOutput output;
+    return output;
+}
+
+/**
+ * @brief The stream the game prints to
+ */
+inline ostream& gameOut() {
+    return gameOutput().stream;
+}
+
+/**
+ * @class RedirectOutput
+ * @brief Sends the game's text to another sink until destroyed
+ */
+class RedirectOutput {
+public:
+    streambuf* saved;  ///< Sink to go back to
+
+    /**
+     * @brief Constructor
+     *
+     * @param sink Stream buffer to write to meanwhile (nullptr: nowhere)
+     */
+    RedirectOutput(streambuf* sink) : saved(gameOutput().sink()) { gameOutput().to(sink); }
+    ~RedirectOutput() { gameOutput().to(saved); }
+    RedirectOutput(const RedirectOutput&) = delete;
+    RedirectOutput& operator=(const RedirectOutput&) = delete;
+};
@@ -0,0 +1,157 @@
+/**
+ * @file pager.cpp
+ * @brief Implementation of PageFile reads and writes and MappedFile
+ *
+ * @author [Ish Soundankar]
+ */
+#include "pager.hpp"
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Seek to a 64-bit file offset
+ *
+ * @return true on success
+ */
+static bool seekTo(FILE* file, long long offset) {
+#ifdef _WIN32
+    return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+/**
+ * @brief Store a record for a key, replacing any earlier one
+ *
+ * Pseudo-code:
+ * 1. IF file not open yet: open it (named file or anonymous temporary file)
+ * 2. IF key has a slot big enough: reuse it
+ *    ELSE:
+ *    a. Round the size up to a power of two (at least MIN_SLOT)
+ *    b. Take a free slot of that size, or reserve one at the end of the file
+ *    c. Free the key's old slot, if it had one
+ * 3. Write the bytes at the slot offset and record the length
+ * 4. Count a page-out
+ *
+ * @param key Record key
+ * @param bytes Record contents
+ * @return true on success
+ */
+bool PageFile::write(long long key, const vector<char>& bytes) {
+    if (!file) {
+        file = path.empty() ? tmpfile() : fopen(path.c_str(), "w+b");
+        if (!file) return false;
+    }
+
+    auto it = slots.find(key);
+    if (it == slots.end() || it->second.capacity < bytes.size()) {
+        unsigned capacity = MIN_SLOT;
+        while (capacity < bytes.size()) capacity *= 2;
+        Slot slot = {fileEnd, 0, capacity};
+        vector<long long>& spare = freeSlots[capacity];
+        if (!spare.empty()) {
+            slot.offset = spare.back();
+            spare.pop_back();
+        } else {
+            fileEnd += capacity;
+        }
+        if (it != slots.end()) freeSlots[it->second.capacity].push_back(it->second.offset);
+        it = slots.insert_or_assign(key, slot).first;
+    }
+
+    if (!seekTo(file, it->second.offset)) return false;
+    if (!bytes.empty() && fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size()) return false;
+    it->second.length = (unsigned)bytes.size();
+    pageOuts++;
+    return true;
+}
+
+/**
+ * @brief Read a key's record back
+ *
+ * Pseudo-code:
+ * 1. IF key has no slot: RETURN false
+ * 2. Seek to the slot and read its length in bytes
+ * 3. Count a page-in
+ *
+ * @param key Record key
+ * @param bytes Replaced with the record contents
+ * @return true on success
+ */
+bool PageFile::read(long long key, vector<char>& bytes) {
+    auto it = slots.find(key);
+    if (!file || it == slots.end()) return false;
+
+    bytes.resize(it->second.length);
+    if (!seekTo(file, it->second.offset)) return false;
+    if (!bytes.empty() && fread(bytes.data(), 1, bytes.size(), file) != bytes.size()) return false;
+    pageIns++;
+    return true;
+}
+
+/**
+ * @brief Map a file
+ *
+ * Pseudo-code:
+ * 1. Close any file already mapped
+ * 2. POSIX: open the file, get its size, mmap it read-only, close the descriptor
+ *    Windows: read the whole file into copy
+ * 3. RETURN false if any step failed
+ *
+ * @param path File name
+ * @return true on success
+ */
+bool MappedFile::open(const string& path) {
+    close();
+#ifdef _WIN32
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    if (_fseeki64(file, 0, SEEK_END) != 0) {
+        fclose(file);
+        return false;
+    }
+    long long length = _ftelli64(file);
+    rewind(file);
+    copy.resize(length > 0 ? (size_t)length : 0);
+    bool ok = length >= 0 && fread(copy.data(), 1, copy.size(), file) == copy.size();
+    fclose(file);
+    if (!ok) {
+        copy.clear();
+        return false;
+    }
+    data = copy.data();
+    size = copy.size();
+    return true;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void* mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) return false;
+    data = (const char*)mapping;
+    size = (size_t)info.st_size;
+    return true;
+#endif
+}
+
+/**
+ * @brief Unmap the file
+ */
+void MappedFile::close() {
+#ifndef _WIN32
+    if (data) munmap((void*)data, size);
+#endif
+    copy.clear();
+    data = nullptr;
+    size = 0;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file pager.hpp
+ * @brief Files backing board chunks that are not in memory
+ *
+ * This file contains the PageFile class and the MappedFile class. The board
+ * writes cold chunks into its PageFile when it is over its memory budget and
+ * reads them back the next time one of their squares is used. A MappedFile
+ * gives read-only access to a save game, so a restored board can decode its
+ * chunks straight from the file when they are first used.
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+using namespace std;
+
+/**
+ * @class PageFile
+ * @brief Keyed byte records stored in one file
+ *
+ * Each key owns one slot in the file. Slot sizes are powers of two (at
+ * least MIN_SLOT bytes), so a record that grows a little still fits its
+ * slot. Rewriting a key reuses its slot when the new record fits and
+ * otherwise moves it to a bigger one: a free slot of that size if there is
+ * one, or a new one at the end. The slot left behind joins the free ones,
+ * so the file stops growing once it holds every record at its largest.
+ * The file is created on the first write and removed when the PageFile is
+ * destroyed.
+ */
+class PageFile {
+public:
+    /**
+     * @struct Slot
+     * @brief Where a key's record lives in the file
+     */
+    struct Slot {
+        long long offset;   ///< Byte offset of the record
+        unsigned length;    ///< Length of the current record
+        unsigned capacity;  ///< Bytes reserved for the slot
+    };
+
+    static const unsigned MIN_SLOT = 256; ///< Smallest slot, in bytes
+
+    string path;                          ///< File name ("" = anonymous temporary file)
+    FILE* file = nullptr;                 ///< Open file (nullptr until the first write)
+    long long fileEnd = 0;                ///< Offset where the next new slot goes
+    unordered_map<long long, Slot> slots; ///< Slot of every key ever written
+    unordered_map<unsigned, vector<long long>> freeSlots;  ///< Offsets of slots no key uses, by capacity
+    unsigned long long pageIns = 0;       ///< Records read back
+    unsigned long long pageOuts = 0;      ///< Records written
+
+    PageFile() {}
+    PageFile(const PageFile&) = delete;
+    PageFile& operator=(const PageFile&) = delete;
+
+    /**
+     * @brief Destructor closes and removes the file
+     */
+    ~PageFile() {
+        if (file) {
+            fclose(file);
+            if (!path.empty()) remove(path.c_str());
+        }
+    }
+
+    /**
+     * @brief Check whether a key has a record in the file
+     */
+    bool contains(long long key) const {
+        return slots.count(key) != 0;
+    }
+
+    /**
+     * @brief Store a record for a key, replacing any earlier one
+     *
+     * @param key Record key
+     * @param bytes Record contents
+     * @return true on success
+     */
+    bool write(long long key, const vector<char>& bytes);
+
+    /**
+     * @brief Read a key's record back
+     *
+     * @param key Record key
+     * @param bytes Replaced with the record contents
+     * @return true on success
+     */
+    bool read(long long key, vector<char>& bytes);
+};
+
+/**
+ * @class MappedFile
+ * @brief Read-only view of a whole file
+ *
+ * On POSIX systems the file is memory-mapped, so opening it costs the same
+ * whatever its size and pages are only read when touched. On Windows the
+ * file is read into memory instead.
+ */
+class MappedFile {
+public:
+    const char* data = nullptr;  ///< First byte of the file (nullptr if not open)
+    size_t size = 0;             ///< File size in bytes
+    vector<char> copy;           ///< File contents where mapping is not used
+
+    MappedFile() {}
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Destructor unmaps the file
+     */
+    ~MappedFile() { close(); }
+
+    /**
+     * @brief Map a file
+     *
+     * @param path File name
+     * @return true on success
+     */
+    bool open(const string& path);
+
+    /**
+     * @brief Unmap the file
+     */
+    void close();
+};
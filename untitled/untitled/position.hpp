@@ -0,0 +1,16 @@
+/**
+ * @file position.hpp
+ * @brief Board coordinate type shared by the board and its helpers
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+
+/**
+ * @struct Position
+ * @brief Row/column coordinate of a square on the board
+ */
+struct Position {
+    int row;     ///< Row index (0 = top edge)
+    int column;  ///< Column index (0 = left edge)
+};
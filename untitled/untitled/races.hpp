@@ -0,0 +1,98 @@
+/**
+ * @file races.hpp
+ * @brief Compile-time stat tables of the races
+ *
+ * This file contains the RaceId numbering, the RaceStats record and one
+ * RaceTraits specialisation per race holding its base stats as constexpr
+ * constants. Orcs have a second set (OrcNight) for the night. The race
+ * constructors and Orc::setTimeOfDay() read them, and code templated on a
+ * traits type (see combat.hpp) gets the numbers folded in as constants.
+ *
+ * @author [Steffy Pereppadan Ignatious]
+ */
+#pragma once
+#include <cstdint>
+
+/**
+ * @enum RaceId
+ * @brief Race numbers (the race menu choice minus one)
+ */
+enum RaceId : uint8_t {
+    RACE_HUMAN,   ///< Human
+    RACE_ELF,     ///< Elf
+    RACE_DWARF,   ///< Dwarf
+    RACE_HOBBIT,  ///< Hobbit
+    RACE_ORC,     ///< Orc
+    RACE_COUNT    ///< Number of races
+};
+
+/**
+ * @struct RaceStats
+ * @brief Base stats a character of a race starts with
+ */
+struct RaceStats {
+    const char* name;     ///< Race name as shown and saved
+    int attack;           ///< Base attack value
+    float attackChance;   ///< Probability of an attack landing
+    int defence;          ///< Base defence value
+    float defenceChance;  ///< Probability of blocking an attack
+    int health;           ///< Starting health
+    int strength;         ///< Carrying capacity
+};
+
+/**
+ * @struct RaceTraits
+ * @brief Stats of one race, known at compile time
+ *
+ * Every specialisation has id (its RaceId) and stats (its RaceStats).
+ */
+template <RaceId Race>
+struct RaceTraits;
+
+template <>
+struct RaceTraits<RACE_HUMAN> {
+    static constexpr RaceId id = RACE_HUMAN;
+    static constexpr RaceStats stats = {"Human", 30, float(2.0 / 3.0), 20, float(1.0 / 2.0), 60, 100};
+};
+
+template <>
+struct RaceTraits<RACE_ELF> {
+    static constexpr RaceId id = RACE_ELF;
+    static constexpr RaceStats stats = {"Elf", 40, float(1.0 / 1.0), 10, float(1.0 / 4.0), 40, 70};
+};
+
+template <>
+struct RaceTraits<RACE_DWARF> {
+    static constexpr RaceId id = RACE_DWARF;
+    static constexpr RaceStats stats = {"Dwarf", 30, float(2.0 / 3.0), 20, float(2.0 / 3.0), 50, 130};
+};
+
+template <>
+struct RaceTraits<RACE_HOBBIT> {
+    static constexpr RaceId id = RACE_HOBBIT;
+    static constexpr RaceStats stats = {"Hobbit", 25, float(1.0 / 3.0), 20, float(2.0 / 3.0), 70, 85};
+};
+
+/// Orc by day (the stats an Orc is created with)
+template <>
+struct RaceTraits<RACE_ORC> {
+    static constexpr RaceId id = RACE_ORC;
+    static constexpr RaceStats stats = {"Orc", 25, 0.25f, 10, 0.25f, 50, 130};
+};
+
+/**
+ * @struct OrcNight
+ * @brief Orc by night: stronger and surer of hitting
+ *
+ * Health and strength are not changed by the time of day.
+ */
+struct OrcNight {
+    static constexpr RaceId id = RACE_ORC;
+    static constexpr RaceStats stats = {"Orc", 45, 1.0f, 25, 0.5f, 50, 130};
+};
+
+using HumanTraits = RaceTraits<RACE_HUMAN>;    ///< Human stats
+using ElfTraits = RaceTraits<RACE_ELF>;        ///< Elf stats
+using DwarfTraits = RaceTraits<RACE_DWARF>;    ///< Dwarf stats
+using HobbitTraits = RaceTraits<RACE_HOBBIT>;  ///< Hobbit stats
+using OrcDay = RaceTraits<RACE_ORC>;           ///< Orc stats by day
@@ -0,0 +1,64 @@
+/**
+ * @file random.hpp
+ * @brief Seedable random number generator for game rolls
+ *
+ * This file contains the GameRandom class used instead of rand() so that
+ * the generator state can be saved with a game and restored exactly.
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <cstdint>
+
+/**
+ * @class GameRandom
+ * @brief splitmix64 random number generator
+ *
+ * The whole state is one 64-bit number, so it is cheap to copy, save
+ * and restore.
+ */
+class GameRandom {
+public:
+    uint64_t state;  ///< Generator state
+
+    /**
+     * @brief Constructor
+     *
+     * @param seed Initial state
+     */
+    GameRandom(uint64_t seed = 0) : state(seed) {}
+
+    /**
+     * @brief Next 64-bit random value
+     */
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief Random integer in [0, n)
+     *
+     * @param n Upper bound (must be > 0)
+     */
+    int nextInt(int n) {
+        return (int)(next() % (uint64_t)n);
+    }
+
+    /**
+     * @brief Random float in [0, 1)
+     */
+    float nextFloat() {
+        return (float)(next() >> 40) * (1.0f / 16777216.0f);
+    }
+};
+
+/**
+ * @brief The generator used for all game rolls (placement, combat, defence)
+ */
+inline GameRandom& gameRandom() {
+    static GameRandom random;
+    return random;
+}
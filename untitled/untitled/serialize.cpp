@@ -0,0 +1,179 @@
+/**
+ * @file serialize.cpp
+ * @brief Implementation of character and chunk encoding
+ *
+ * @author [Steffy Pereppadan Ignatious]
+ */
+#include "serialize.hpp"
+#include "board.hpp"
+#include "ItemsDB.h"
+
+/**
+ * @brief Create an unequipped character of a race given by name
+ *
+ * @param race Race name ("Human", "Elf", "Dwarf", "Hobbit" or "Orc")
+ * @param name Character's name
+ * @return New character, or nullptr for an unknown race
+ */
+static shared_ptr<Character> makeCharacter(const string& race, const string& name) {
+    if (race == "Human") return make_shared<Human>(name);
+    if (race == "Elf") return make_shared<Elf>(name);
+    if (race == "Dwarf") return make_shared<Dwarf>(name);
+    if (race == "Hobbit") return make_shared<Hobbit>(name);
+    if (race == "Orc") return make_shared<Orc>(name);
+    return nullptr;
+}
+
+/**
+ * @brief Encode a character (stats, race, equipment by item id)
+ *
+ * Pseudo-code:
+ * 1. Write race and name
+ * 2. Write base stats and the Orc time-of-day flag
+ * 3. Write weapon, armour and shield ids (-1 for empty slots)
+ * 4. Write ring ids, then inventory ids, each preceded by a count
+ *
+ * @param out Writer to append to
+ * @param character Character to encode
+ */
+void writeCharacter(ByteWriter& out, const Character& character) {
+    out.putString(character.race);
+    out.putString(character.name);
+    out.put<int32_t>(character.attack);
+    out.put<float>(character.attack_chance);
+    out.put<int32_t>(character.defence);
+    out.put<float>(character.defence_chance);
+    out.put<int32_t>(character.health);
+    out.put<int32_t>(character.strength);
+    const Orc* orc = dynamic_cast<const Orc*>(&character);
+    out.put<uint8_t>(orc && orc->isNight ? 1 : 0);
+
+    out.put<int8_t>((int8_t)itemId(character.weapon));
+    out.put<int8_t>((int8_t)itemId(character.armor));
+    out.put<int8_t>((int8_t)itemId(character.shield));
+    out.put<uint16_t>((uint16_t)character.ring.size());
+    for (const auto& r : character.ring) out.put<int8_t>((int8_t)itemId(r));
+    out.put<uint16_t>((uint16_t)character.inventory.size());
+    for (const auto& item : character.inventory) out.put<int8_t>((int8_t)itemId(item));
+}
+
+/**
+ * @brief Decode a character written by writeCharacter()
+ *
+ * Pseudo-code:
+ * 1. Read race and name, create a character of that race
+ * 2. Overwrite its base stats with the stored ones
+ * 3. Re-equip weapon, armour, shield and rings from their item ids
+ * 4. Rebuild the inventory from its item ids
+ * 5. RETURN nullptr if the race is unknown or the data ran out
+ *
+ * @param in Reader positioned at the character
+ * @return New character, or nullptr if the data is bad
+ */
+shared_ptr<Character> readCharacter(ByteReader& in) {
+    string race = in.getString();
+    string name = in.getString();
+    shared_ptr<Character> character = makeCharacter(race, name);
+    if (!character) {
+        in.ok = false;
+        return nullptr;
+    }
+
+    character->attack = in.get<int32_t>();
+    character->attack_chance = in.get<float>();
+    character->defence = in.get<int32_t>();
+    character->defence_chance = in.get<float>();
+    character->health = in.get<int32_t>();
+    character->strength = in.get<int32_t>();
+    bool night = in.get<uint8_t>() != 0;
+    if (Orc* orc = dynamic_cast<Orc*>(character.get())) orc->isNight = night;
+
+    character->weapon = dynamic_pointer_cast<Weapon>(itemById(in.get<int8_t>()));
+    character->armor = dynamic_pointer_cast<Armour>(itemById(in.get<int8_t>()));
+    character->shield = dynamic_pointer_cast<Shield>(itemById(in.get<int8_t>()));
+    uint16_t rings = in.get<uint16_t>();
+    for (uint16_t i = 0; i < rings && in.ok; i++) {
+        auto r = dynamic_pointer_cast<Ring>(itemById(in.get<int8_t>()));
+        if (r) character->ring.push_back(r);
+    }
+    uint16_t carried = in.get<uint16_t>();
+    for (uint16_t i = 0; i < carried && in.ok; i++) {
+        auto item = itemById(in.get<int8_t>());
+        if (item) character->inventory.push_back(item);
+    }
+    return in.ok ? character : nullptr;
+}
+
+/**
+ * @brief Encode the contents of a chunk (entities, explored bits and walls)
+ *
+ * Pseudo-code:
+ * 1. Write the explored bits (one word per row)
+ * 2. Count squares holding an enemy or item and write the count
+ * 3. FOR each such square:
+ *    a. Write its index and a flag byte (1 = enemy, 2 = item)
+ *    b. IF item: write its id
+ *    c. IF enemy: write the character
+ * 4. IF the chunk has any walls: write the wall bits (one word per row)
+ *
+ * @param out Writer to append to
+ * @param chunk Chunk to encode
+ */
+void writeChunk(ByteWriter& out, const Chunk& chunk) {
+    for (int i = 0; i < Chunk::SIZE; i++) out.put<uint64_t>(chunk.explored[i]);
+
+    uint16_t occupied = 0;
+    for (const Square& square : chunk.squares) {
+        if (square.enemy || square.item) occupied++;
+    }
+    out.put<uint16_t>(occupied);
+
+    for (int i = 0; i < Chunk::SIZE * Chunk::SIZE; i++) {
+        const Square& square = chunk.squares[i];
+        if (!square.enemy && !square.item) continue;
+        out.put<uint16_t>((uint16_t)i);
+        out.put<uint8_t>((square.enemy ? 1 : 0) | (square.item ? 2 : 0));
+        if (square.item) out.put<int8_t>((int8_t)itemId(square.item));
+        if (square.enemy) writeCharacter(out, *square.enemy);
+    }
+
+    bool anyWalls = false;
+    for (uint64_t row : chunk.walls) anyWalls |= row != 0;
+    if (anyWalls) {
+        for (int i = 0; i < Chunk::SIZE; i++) out.put<uint64_t>(chunk.walls[i]);
+    }
+}
+
+/**
+ * @brief Decode a chunk written by writeChunk() into an empty chunk
+ *
+ * Pseudo-code:
+ * 1. Read the explored bits
+ * 2. Read the count of occupied squares
+ * 3. FOR each: read index and flags, then the item id and/or character
+ * 4. IF there is more: read the wall bits (otherwise the chunk has none)
+ * 5. RETURN whether all data was present
+ *
+ * @param in Reader positioned at the chunk
+ * @param chunk Freshly allocated chunk to fill
+ * @return true if the data was complete
+ */
+bool readChunk(ByteReader& in, Chunk& chunk) {
+    for (int i = 0; i < Chunk::SIZE; i++) chunk.explored[i] = in.get<uint64_t>();
+
+    uint16_t occupied = in.get<uint16_t>();
+    for (uint16_t n = 0; n < occupied && in.ok; n++) {
+        uint16_t i = in.get<uint16_t>();
+        uint8_t flags = in.get<uint8_t>();
+        if (i >= Chunk::SIZE * Chunk::SIZE) {
+            in.ok = false;
+            break;
+        }
+        if (flags & 2) chunk.squares[i].item = itemById(in.get<int8_t>());
+        if (flags & 1) chunk.squares[i].enemy = readCharacter(in);
+    }
+    if (in.ok && in.next < in.end) {
+        for (int i = 0; i < Chunk::SIZE; i++) chunk.walls[i] = in.get<uint64_t>();
+    }
+    return in.ok;
+}
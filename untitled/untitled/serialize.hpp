@@ -0,0 +1,144 @@
+/**
+ * @file serialize.hpp
+ * @brief Binary encoding of characters and board chunks
+ *
+ * This file contains small byte writer/reader helpers and the functions that
+ * turn characters and chunks into bytes and back. Items are stored by their
+ * ItemsDB id. Values are written in native byte order, so the data is meant
+ * for files read back on the same machine (page files, save games).
+ *
+ * @author [Steffy Pereppadan Ignatious]
+ */
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include "characters.hpp"
+
+using namespace std;
+
+class Chunk;
+
+/**
+ * @class ByteWriter
+ * @brief Appends plain values and strings to a byte buffer
+ */
+class ByteWriter {
+public:
+    vector<char>& out;  ///< Buffer being appended to
+
+    /**
+     * @brief Constructor
+     *
+     * @param buffer Buffer to append to (not cleared)
+     */
+    ByteWriter(vector<char>& buffer) : out(buffer) {}
+
+    /**
+     * @brief Append the raw bytes of a trivially copyable value
+     */
+    template <typename T>
+    void put(T value) {
+        size_t at = out.size();
+        out.resize(at + sizeof(T));
+        memcpy(out.data() + at, &value, sizeof(T));
+    }
+
+    /**
+     * @brief Append a string as a 16-bit length followed by its characters
+     */
+    void putString(const string& s) {
+        put<uint16_t>((uint16_t)s.size());
+        out.insert(out.end(), s.begin(), s.begin() + (uint16_t)s.size());
+    }
+};
+
+/**
+ * @class ByteReader
+ * @brief Reads values written by ByteWriter back out of a byte range
+ *
+ * Reading past the end sets ok to false and returns zero values, so callers
+ * can decode a whole record and check ok once at the end.
+ */
+class ByteReader {
+public:
+    const char* next;  ///< Next byte to read
+    const char* end;   ///< One past the last byte
+    bool ok = true;    ///< false once a read ran past the end
+
+    /**
+     * @brief Constructor
+     *
+     * @param data First byte
+     * @param size Number of bytes available
+     */
+    ByteReader(const char* data, size_t size) : next(data), end(data + size) {}
+
+    /**
+     * @brief Read a trivially copyable value
+     */
+    template <typename T>
+    T get() {
+        T value{};
+        if ((size_t)(end - next) < sizeof(T)) {
+            ok = false;
+            next = end;
+            return value;
+        }
+        memcpy(&value, next, sizeof(T));
+        next += sizeof(T);
+        return value;
+    }
+
+    /**
+     * @brief Read a string written by ByteWriter::putString()
+     */
+    string getString() {
+        uint16_t length = get<uint16_t>();
+        if ((size_t)(end - next) < length) {
+            ok = false;
+            next = end;
+            return string();
+        }
+        string s(next, length);
+        next += length;
+        return s;
+    }
+};
+
+/**
+ * @brief Encode a character (stats, race, equipment by item id)
+ *
+ * @param out Writer to append to
+ * @param character Character to encode
+ */
+void writeCharacter(ByteWriter& out, const Character& character);
+
+/**
+ * @brief Decode a character written by writeCharacter()
+ *
+ * @param in Reader positioned at the character
+ * @return New character of the stored race, or nullptr if the data is bad
+ */
+shared_ptr<Character> readCharacter(ByteReader& in);
+
+/**
+ * @brief Encode the contents of a chunk (entities, explored bits and walls)
+ *
+ * The player, visibility and route-finding scratch are not stored.
+ *
+ * @param out Writer to append to
+ * @param chunk Chunk to encode
+ */
+void writeChunk(ByteWriter& out, const Chunk& chunk);
+
+/**
+ * @brief Decode a chunk written by writeChunk() into an empty chunk
+ *
+ * @param in Reader positioned at the chunk
+ * @param chunk Freshly allocated chunk to fill
+ * @return true if the data was complete
+ */
+bool readChunk(ByteReader& in, Chunk& chunk);
@@ -0,0 +1,197 @@
+/**
+ * @file snapshot.cpp
+ * @brief Implementation of save game writing and loading
+ *
+ * @author [Ish Soundankar]
+ */
+#include "snapshot.hpp"
+#include "serialize.hpp"
+#include "random.hpp"
+#include <cstdio>
+#include <cstring>
+
+/**
+ * @brief Write a byte range, remembering whether every write succeeded
+ */
+static void writeBytes(FILE* file, const void* data, size_t size, bool& ok) {
+    if (ok && size > 0 && fwrite(data, 1, size, file) != size) ok = false;
+}
+
+/**
+ * @brief Write one chunk record (key, length, bytes)
+ */
+static void writeChunkRecord(FILE* file, long long key, const char* data, uint32_t length, bool& ok) {
+    int64_t storedKey = key;
+    writeBytes(file, &storedKey, sizeof(storedKey), ok);
+    writeBytes(file, &length, sizeof(length), ok);
+    writeBytes(file, data, length, ok);
+}
+
+/**
+ * @brief Write a game session to a save file
+ *
+ * Pseudo-code:
+ * 1. Open "<path>.tmp" with a large write buffer
+ * 2. Count the chunks to store: resident chunks, chunks only in the page
+ *    file, and chunks of an earlier save that were never decoded
+ * 3. Write the header
+ * 4. Write the player record and the enemy/item position arrays
+ * 5. FOR each chunk: write its record (resident chunks are encoded; paged
+ *    and never-decoded chunks are copied as stored)
+ * 6. Close, then move the temporary file over path
+ *
+ * @param path File name (replaced if it exists)
+ * @param session Session to save
+ * @return true on success
+ */
+bool saveSnapshot(const string& path, GameSession& session) {
+    Board& board = *session.board;
+    string temporary = path + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (!file) return false;
+    setvbuf(file, nullptr, _IOFBF, 1 << 20);
+
+    uint64_t chunkCount = board.chunks.size();
+    for (const auto& slot : board.pageFile.slots) {
+        if (!board.chunks.count(slot.first)) chunkCount++;
+    }
+    for (const auto& record : board.snapshotChunks) {
+        if (!board.chunks.count(record.first) && !board.pageFile.contains(record.first)) chunkCount++;
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "APGS", 4);
+    header.version = SNAPSHOT_VERSION;
+    header.width = board.width;
+    header.height = board.height;
+    header.seed = board.seed;
+    header.endless = board.endless ? 1 : 0;
+    header.isNight = session.isNight ? 1 : 0;
+    header.fogOfWar = board.fogOfWar ? 1 : 0;
+    header.walled = board.walled ? 1 : 0;
+    header.sightRadius = board.sightRadius;
+    header.playerRow = session.playerRow;
+    header.playerColumn = session.playerColumn;
+    header.gold = session.gold;
+    header.commandCount = session.commandCount;
+    header.turn = session.turn;
+    header.randomState = gameRandom().state;
+    header.enemyCount = board.enemyIndex.size();
+    header.itemCount = board.itemIndex.size();
+    header.chunkCount = chunkCount;
+
+    bool ok = true;
+    writeBytes(file, &header, sizeof(header), ok);
+
+    vector<char> buffer;
+    ByteWriter out(buffer);
+    writeCharacter(out, *session.player);
+    uint32_t length = (uint32_t)buffer.size();
+    writeBytes(file, &length, sizeof(length), ok);
+    writeBytes(file, buffer.data(), buffer.size(), ok);
+
+    board.enemyIndex.forEach([&](Position p) { writeBytes(file, &p, sizeof(p), ok); });
+    board.itemIndex.forEach([&](Position p) { writeBytes(file, &p, sizeof(p), ok); });
+
+    for (const auto& entry : board.chunks) {
+        buffer.clear();
+        writeChunk(out, *entry.second);
+        writeChunkRecord(file, entry.first, buffer.data(), (uint32_t)buffer.size(), ok);
+    }
+    for (const auto& slot : board.pageFile.slots) {
+        if (board.chunks.count(slot.first)) continue;
+        ok = ok && board.pageFile.read(slot.first, buffer);
+        writeChunkRecord(file, slot.first, buffer.data(), (uint32_t)buffer.size(), ok);
+    }
+    for (const auto& record : board.snapshotChunks) {
+        if (board.chunks.count(record.first) || board.pageFile.contains(record.first)) continue;
+        writeChunkRecord(file, record.first, record.second.first, record.second.second, ok);
+    }
+
+    if (fclose(file) != 0) ok = false;
+    if (!ok) {
+        remove(temporary.c_str());
+        return false;
+    }
+    remove(path.c_str());
+    return rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+/**
+ * @brief Restore a game session from a save file
+ *
+ * Pseudo-code:
+ * 1. Map the file; check size, magic and version (version 1 files have no
+ *    turn counter, which is 0 in them)
+ * 2. Create a board with the saved size (or world seed) and settings;
+ *    fail unless a bounded board's size is positive, the sight radius is
+ *    between 1 and MAX_SIGHT_RADIUS and the player is on the board
+ * 3. Decode the player record
+ * 4. Rebuild the enemy and item indexes from the position arrays (failing
+ *    on any position off the board)
+ * 5. Note where each chunk record is (chunks are decoded on first use)
+ * 6. Restore counters and the random generator, then swap everything into session
+ *
+ * @param path File name
+ * @param session Session to replace (left unchanged on failure)
+ * @return true on success
+ */
+bool loadSnapshot(const string& path, GameSession& session) {
+    auto file = make_shared<MappedFile>();
+    if (!file->open(path) || file->size < sizeof(SnapshotHeader)) return false;
+
+    SnapshotHeader header;
+    memcpy(&header, file->data, sizeof(header));
+    if (memcmp(header.magic, "APGS", 4) != 0 || header.version < 1 || header.version > SNAPSHOT_VERSION) {
+        return false;
+    }
+    if (!header.endless && (header.width <= 0 || header.height <= 0)) return false;
+    if (header.sightRadius < 1 || header.sightRadius > Board::MAX_SIGHT_RADIUS) return false;
+
+    unique_ptr<Board> board = header.endless ? make_unique<Board>(header.seed)
+                                             : make_unique<Board>(header.width, header.height);
+    board->night = header.isNight != 0;
+    board->fogOfWar = header.fogOfWar != 0;
+    board->walled = header.walled != 0;
+    board->sightRadius = header.sightRadius;
+    if (!board->inBounds(header.playerRow, header.playerColumn)) return false;
+
+    ByteReader in(file->data + sizeof(header), file->size - sizeof(header));
+    uint32_t length = in.get<uint32_t>();
+    if ((size_t)(in.end - in.next) < length) return false;
+    ByteReader playerIn(in.next, length);
+    shared_ptr<Character> player = readCharacter(playerIn);
+    if (!player) return false;
+    in.next += length;
+
+    if ((size_t)(in.end - in.next) / sizeof(Position) < header.enemyCount + header.itemCount) {
+        return false;
+    }
+    for (uint64_t i = 0; i < header.enemyCount + header.itemCount; i++) {
+        Position p = in.get<Position>();
+        if (!board->inBounds(p.row, p.column)) return false;
+        (i < header.enemyCount ? board->enemyIndex : board->itemIndex).insert(p);
+    }
+
+    for (uint64_t i = 0; i < header.chunkCount; i++) {
+        long long key = in.get<int64_t>();
+        uint32_t chunkLength = in.get<uint32_t>();
+        if (!in.ok || (size_t)(in.end - in.next) < chunkLength) return false;
+        board->snapshotChunks[key] = {in.next, chunkLength};
+        in.next += chunkLength;
+    }
+    board->snapshotFile = file;
+
+    gameRandom().state = header.randomState;
+    session.board = move(board);
+    session.player = player;
+    session.playerRow = header.playerRow;
+    session.playerColumn = header.playerColumn;
+    session.gold = header.gold;
+    session.commandCount = header.commandCount;
+    session.turn = header.turn;
+    session.gameOver = false;
+    session.isNight = header.isNight != 0;
+    return true;
+}
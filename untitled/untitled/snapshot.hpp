@@ -0,0 +1,71 @@
+/**
+ * @file snapshot.hpp
+ * @brief Save and restore a whole game session
+ *
+ * This file contains the binary save game format and the functions that
+ * write and load it. A save file holds, in order:
+ *
+ * 1. SnapshotHeader (fixed size: version, board settings, counters, RNG state)
+ * 2. The player character (length-prefixed writeCharacter() record)
+ * 3. Enemy positions, then item positions (raw Position arrays)
+ * 4. One record per board chunk: key, length, writeChunk() bytes (which
+ *    end with the chunk's walls from version 3 on, if it has any)
+ *
+ * Saving writes the file front to back in one pass. Loading maps the file
+ * and only reads the header, player and positions; each chunk is decoded
+ * from the mapping the first time the board touches it.
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <string>
+#include <cstdint>
+#include "game.hpp"
+
+using namespace std;
+
+/**
+ * @struct SnapshotHeader
+ * @brief Fixed-size start of a save file
+ */
+struct SnapshotHeader {
+    char magic[4];          ///< "APGS"
+    uint32_t version;       ///< SNAPSHOT_VERSION of the writer
+    int32_t width;          ///< Board width
+    int32_t height;         ///< Board height
+    uint32_t seed;          ///< World seed (endless boards)
+    uint8_t endless;        ///< 1 for an endless board
+    uint8_t isNight;        ///< Time of day
+    uint8_t fogOfWar;       ///< Fog of war setting
+    uint8_t walled;         ///< 1 if the board has walls (version 3; always 0 before)
+    int32_t sightRadius;    ///< Player's sight radius
+    int32_t playerRow;      ///< Player's row
+    int32_t playerColumn;   ///< Player's column
+    int32_t gold;           ///< Gold collected
+    int32_t commandCount;   ///< Commands that advanced the clock
+    int32_t turn;           ///< Commands played (version 2; 0 in version 1)
+    uint64_t randomState;   ///< gameRandom() state
+    uint64_t enemyCount;    ///< Entries in the enemy position array
+    uint64_t itemCount;     ///< Entries in the item position array
+    uint64_t chunkCount;    ///< Chunk records at the end of the file
+};
+
+const uint32_t SNAPSHOT_VERSION = 3;  ///< Bump whenever the format changes
+
+/**
+ * @brief Write a game session to a save file
+ *
+ * @param path File name (replaced if it exists)
+ * @param session Session to save
+ * @return true on success
+ */
+bool saveSnapshot(const string& path, GameSession& session);
+
+/**
+ * @brief Restore a game session from a save file
+ *
+ * @param path File name
+ * @param session Session to replace (left unchanged on failure)
+ * @return true on success
+ */
+bool loadSnapshot(const string& path, GameSession& session);
@@ -0,0 +1,150 @@
+/**
+ * @file spatial.cpp
+ * @brief Implementation of SpatialIndex queries
+ *
+ * This file contains the insert/remove bookkeeping and the ring search used
+ * to answer nearest-neighbour and radius queries.
+ *
+ * @author [Ish Soundankar]
+ */
+#include "spatial.hpp"
+#include <cstdlib>   // abs
+#include <algorithm> // min, max
+
+/**
+ * @brief Add a position to the index
+ *
+ * Pseudo-code:
+ * 1. Append position to the bucket containing it (creating the bucket if needed)
+ * 2. Grow the used bucket range to include that bucket
+ * 3. Increase count
+ *
+ * @param p Position to add
+ */
+void SpatialIndex::insert(Position p) {
+    int bucketRow = bucketOf(p.row);
+    int bucketColumn = bucketOf(p.column);
+    buckets[keyOf(bucketRow, bucketColumn)].push_back(p);
+
+    if (maxBucketRow < minBucketRow) {
+        minBucketRow = maxBucketRow = bucketRow;
+        minBucketColumn = maxBucketColumn = bucketColumn;
+    } else {
+        if (bucketRow < minBucketRow) minBucketRow = bucketRow;
+        if (bucketRow > maxBucketRow) maxBucketRow = bucketRow;
+        if (bucketColumn < minBucketColumn) minBucketColumn = bucketColumn;
+        if (bucketColumn > maxBucketColumn) maxBucketColumn = bucketColumn;
+    }
+    count++;
+}
+
+/**
+ * @brief Remove a position from the index
+ *
+ * Pseudo-code:
+ * 1. Look up the bucket containing the position
+ * 2. FOR each entry in bucket:
+ *    - IF it matches: overwrite with the last entry, shrink bucket, decrease count
+ *    - RETURN true
+ * 3. RETURN false (not found)
+ *
+ * @param p Position to remove
+ * @return true if the position was present
+ */
+bool SpatialIndex::remove(Position p) {
+    auto it = buckets.find(keyOf(bucketOf(p.row), bucketOf(p.column)));
+    if (it == buckets.end()) return false;
+
+    vector<Position>& bucket = it->second;
+    for (size_t i = 0; i < bucket.size(); i++) {
+        if (bucket[i].row == p.row && bucket[i].column == p.column) {
+            bucket[i] = bucket.back();
+            bucket.pop_back();
+            count--;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Find the indexed position closest to a point
+ *
+ * Pseudo-code:
+ * 1. IF index empty: RETURN false
+ * 2. FOR ring = 0, 1, 2, ... (square rings of buckets around the query bucket):
+ *    a. FOR each bucket on the ring: compare every entry with the best so far
+ *    b. IF a best exists AND best distance <= ring * BUCKET_SIZE:
+ *       nothing on a further ring can be closer, stop
+ *    c. IF the ring already covers every bucket ever used: stop
+ * 3. RETURN true with best position
+ *
+ * @param from Query point
+ * @param found Set to the closest position
+ * @return true if the index is not empty
+ */
+bool SpatialIndex::nearest(Position from, Position& found) const {
+    if (count == 0) return false;
+
+    int centerRow = bucketOf(from.row);
+    int centerColumn = bucketOf(from.column);
+    int lastRing = max(max(centerRow - minBucketRow, maxBucketRow - centerRow),
+                       max(centerColumn - minBucketColumn, maxBucketColumn - centerColumn));
+    int best = -1;
+
+    for (int ring = 0; ring <= lastRing; ring++) {
+        for (int bucketRow = centerRow - ring; bucketRow <= centerRow + ring; bucketRow++) {
+            bool edgeRow = (bucketRow == centerRow - ring || bucketRow == centerRow + ring);
+            // Interior rows of the ring only have their two end buckets on it
+            int step = edgeRow ? 1 : 2 * ring;
+            for (int bucketColumn = centerColumn - ring; bucketColumn <= centerColumn + ring;
+                 bucketColumn += step) {
+                auto it = buckets.find(keyOf(bucketRow, bucketColumn));
+                if (it == buckets.end()) continue;
+                for (const Position& p : it->second) {
+                    int distance = abs(p.row - from.row) + abs(p.column - from.column);
+                    if (best < 0 || distance < best) {
+                        best = distance;
+                        found = p;
+                    }
+                }
+            }
+        }
+        if (best >= 0 && best <= ring * BUCKET_SIZE) break;
+    }
+    return best >= 0;
+}
+
+/**
+ * @brief Collect every indexed position within a distance of a point
+ *
+ * Pseudo-code:
+ * 1. Clear output
+ * 2. FOR each bucket overlapping the square [center - radius, center + radius]:
+ *    a. FOR each entry: IF Manhattan distance <= radius: append to output
+ *
+ * @param center Query point
+ * @param radius Maximum Manhattan distance (inclusive)
+ * @param out Matching positions
+ */
+void SpatialIndex::withinRadius(Position center, int radius, vector<Position>& out) const {
+    out.clear();
+    if (count == 0 || radius < 0) return;
+
+    int firstRow = max(bucketOf(center.row - radius), minBucketRow);
+    int lastRow = min(bucketOf(center.row + radius), maxBucketRow);
+    int firstColumn = max(bucketOf(center.column - radius), minBucketColumn);
+    int lastColumn = min(bucketOf(center.column + radius), maxBucketColumn);
+
+    for (int bucketRow = firstRow; bucketRow <= lastRow; bucketRow++) {
+        for (int bucketColumn = firstColumn; bucketColumn <= lastColumn; bucketColumn++) {
+            auto it = buckets.find(keyOf(bucketRow, bucketColumn));
+            if (it == buckets.end()) continue;
+            for (const Position& p : it->second) {
+                if (abs(p.row - center.row) + abs(p.column - center.column) <= radius) {
+                    out.push_back(p);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,112 @@
+/**
+ * @file spatial.hpp
+ * @brief Uniform-grid spatial index for entity positions
+ *
+ * This file contains the SpatialIndex class, which buckets board positions
+ * into fixed-size cells so that "nearest" and "within radius" questions only
+ * look at the handful of buckets around the query point instead of scanning
+ * the whole board.
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include "position.hpp"
+
+using namespace std;
+
+/**
+ * @class SpatialIndex
+ * @brief Positions of one kind of entity, bucketed on a coarse grid
+ *
+ * Buckets are BUCKET_SIZE x BUCKET_SIZE squares and are only created when
+ * something is inserted into them, so the index does not depend on the
+ * board dimensions. Distances are Manhattan distances (the number of
+ * steps a character needs with 4-way movement).
+ */
+class SpatialIndex {
+public:
+    static const int BUCKET_SIZE = 16;  ///< Width/height of a bucket in squares
+
+    /**
+     * @brief Add a position to the index
+     *
+     * @param p Position to add
+     */
+    void insert(Position p);
+
+    /**
+     * @brief Remove a position from the index
+     *
+     * @param p Position to remove
+     * @return true if the position was present
+     */
+    bool remove(Position p);
+
+    /**
+     * @brief Find the indexed position closest to a point
+     *
+     * @param from Query point
+     * @param found Set to the closest position (ties: first found)
+     * @return true if the index is not empty
+     */
+    bool nearest(Position from, Position& found) const;
+
+    /**
+     * @brief Collect every indexed position within a distance of a point
+     *
+     * @param center Query point
+     * @param radius Maximum Manhattan distance (inclusive)
+     * @param out Cleared, then filled with matching positions
+     */
+    void withinRadius(Position center, int radius, vector<Position>& out) const;
+
+    /**
+     * @brief Call a function for every position in the index
+     *
+     * @param visit Callable taking a Position
+     */
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        for (const auto& bucket : buckets) {
+            for (const Position& p : bucket.second) visit(p);
+        }
+    }
+
+    /**
+     * @brief Number of positions in the index
+     */
+    size_t size() const { return count; }
+
+    /**
+     * @brief Remove every position
+     */
+    void clear() {
+        buckets.clear();
+        count = 0;
+        minBucketRow = minBucketColumn = 0;
+        maxBucketRow = maxBucketColumn = -1;
+    }
+
+    unordered_map<long long, vector<Position>> buckets;  ///< Non-empty buckets by key
+    size_t count = 0;                                    ///< Total positions stored
+    int minBucketRow = 0;     ///< Smallest bucket row ever used
+    int maxBucketRow = -1;    ///< Largest bucket row ever used (< min while empty)
+    int minBucketColumn = 0;  ///< Smallest bucket column ever used
+    int maxBucketColumn = -1; ///< Largest bucket column ever used
+
+    /**
+     * @brief Bucket coordinate containing a board coordinate
+     */
+    static int bucketOf(int v) {
+        return v >= 0 ? v / BUCKET_SIZE : -((-v - 1) / BUCKET_SIZE) - 1;
+    }
+
+    /**
+     * @brief Hash-map key of a bucket
+     */
+    static long long keyOf(int bucketRow, int bucketColumn) {
+        return ((long long)bucketRow << 32) ^ (unsigned int)bucketColumn;
+    }
+};
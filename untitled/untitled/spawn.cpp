@@ -0,0 +1,283 @@
+/**
+ * @file spawn.cpp
+ * @brief Keeping squares clear with a distance transform and Poisson-disk sampling
+ *
+ * @author [Ish Soundankar]
+ */
+#include "spawn.hpp"
+#include <algorithm>
+#include <cmath> // sqrt
+
+/**
+ * @brief Largest integer whose square is at most n (n >= 0)
+ */
+static long long squareRoot(long long n) {
+    long long root = (long long)sqrt((double)n);
+    while (root * root > n) root--;
+    while ((root + 1) * (root + 1) <= n) root++;
+    return root;
+}
+
+/**
+ * @brief Constructor, nothing blocked
+ *
+ * @param w Width of the board
+ * @param h Height of the board
+ */
+SpawnSampler::SpawnSampler(int w, int h) : width(w), height(h), words((w + 63) / 64) {
+    clear();
+}
+
+/**
+ * @brief Unblock every square (past the last column aside)
+ */
+void SpawnSampler::clear() {
+    blocked.assign((size_t)words * height, 0);
+    uint64_t padding = paddingMask();
+    if (padding) {
+        for (int row = 0; row < height; row++) blocked[(size_t)row * words + words - 1] = padding;
+    }
+}
+
+/**
+ * @brief Spacing that lays about SPREAD points per point needed over a board (at least least)
+ *
+ * Points spacing apart cover about spacing * spacing squares each, so the
+ * spacing is the square root of the squares per point wanted.
+ *
+ * @param least Smallest spacing allowed
+ * @param squares Squares of the board
+ * @param needed Points the caller will pick
+ * @return The spacing
+ */
+int SpawnSampler::spreadSpacing(int least, long long squares, size_t needed) {
+    if (needed == 0) return least;
+    long long spread = squareRoot(squares / ((long long)needed * SPREAD));
+    return (int)max<long long>(least, min<long long>(spread, 1 << 30));
+}
+
+/**
+ * @brief Block every square fewer than radius steps from any of seeds (distance transform)
+ *
+ * Only the seeds' bounding box grown by radius is transformed: every
+ * square outside it is at least radius steps from every seed, and a
+ * shortest (Manhattan) path between two squares of the box stays in it.
+ *
+ * Pseudo-code:
+ * 1. Find the box around the seeds, grown by radius and clipped to the board
+ * 2. Set every square's distance to 0 at a seed and 255 (far) elsewhere
+ * 3. FOR each square, top to bottom, left to right:
+ *    distance = min(distance, above + 1, left + 1)
+ * 4. FOR each square, bottom to top, right to left:
+ *    a. distance = min(distance, below + 1, right + 1), now the exact
+ *       number of steps to the nearest seed
+ *    b. IF it is less than radius: block the square
+ *
+ * @param seeds Squares to keep clear around (those off the board are ignored)
+ * @param radius Steps (Manhattan) a square must be from every seed to stay unblocked (at most 255)
+ */
+void SpawnSampler::keepClear(const vector<Position>& seeds, int radius) {
+    radius = min(radius, 255);
+    int top = height, left = width, bottom = -1, right = -1;
+    for (const Position& seed : seeds) {
+        if (seed.row >= 0 && seed.row < height && seed.column >= 0 && seed.column < width) {
+            top = min(top, seed.row);
+            bottom = max(bottom, seed.row);
+            left = min(left, seed.column);
+            right = max(right, seed.column);
+        }
+    }
+    if (radius <= 0 || bottom < 0) return;
+    top = max(0, top - radius + 1);
+    left = max(0, left - radius + 1);
+    bottom = min(height - 1, bottom + radius - 1);
+    right = min(width - 1, right + radius - 1);
+    int rows = bottom - top + 1;
+    int columns = right - left + 1;
+    distance.assign((size_t)rows * columns, 255);
+    for (const Position& seed : seeds) {
+        if (seed.row >= top && seed.row <= bottom && seed.column >= left && seed.column <= right) {
+            distance[(size_t)(seed.row - top) * columns + seed.column - left] = 0;
+        }
+    }
+
+    for (int row = 0; row < rows; row++) {
+        uint8_t* line = &distance[(size_t)row * columns];
+        const uint8_t* above = row > 0 ? line - columns : nullptr;
+        for (int column = 0; column < columns; column++) {
+            int d = line[column];
+            if (above && above[column] + 1 < d) d = above[column] + 1;
+            if (column > 0 && line[column - 1] + 1 < d) d = line[column - 1] + 1;
+            line[column] = (uint8_t)d;
+        }
+    }
+    for (int row = rows - 1; row >= 0; row--) {
+        uint8_t* line = &distance[(size_t)row * columns];
+        const uint8_t* below = row < rows - 1 ? line + columns : nullptr;
+        for (int column = columns - 1; column >= 0; column--) {
+            int d = line[column];
+            if (below && below[column] + 1 < d) d = below[column] + 1;
+            if (column < columns - 1 && line[column + 1] + 1 < d) d = line[column + 1] + 1;
+            line[column] = (uint8_t)d;
+            if (d < radius) block(top + row, left + column);
+        }
+    }
+}
+
+/**
+ * @brief Block every square closer than spacing to a point (which may lie off the board)
+ *
+ * Lets points sampled separately on neighbouring parts of a board keep
+ * their spacing: each part keeps away from the points already placed in
+ * the parts next to it.
+ *
+ * Pseudo-code:
+ * FOR each row of the board fewer than spacing rows from the point:
+ *    block the run of columns whose squares are closer than spacing
+ *
+ * @param row Point's row (may be negative or past the last row)
+ * @param column Point's column
+ * @param spacing Distance (straight line) a square must be from the point to stay unblocked
+ */
+void SpawnSampler::keepAway(int row, int column, int spacing) {
+    long long minimum = (long long)spacing * spacing;
+    int firstRow = max(0, row - spacing + 1);
+    int lastRow = min(height - 1, row + spacing - 1);
+    for (int r = firstRow; r <= lastRow; r++) {
+        long long dRow = r - row;
+        int half = (int)squareRoot(minimum - 1 - dRow * dRow);
+        int last = min(width - 1, column + half);
+        for (int c = max(0, column - half); c <= last; c++) block(r, c);
+    }
+}
+
+/**
+ * @brief Lay Poisson-disk points over the unblocked squares
+ *
+ * A square fits if it is unblocked and no point is closer than spacing.
+ * Points are kept in a background grid of cells small enough (squares
+ * of one less than spacing / sqrt(2) apart at most) that no two can share
+ * one, so a square is checked against the few cells around it only.
+ *
+ * Pseudo-code:
+ * 1. Empty the grid and the points
+ * 2. FOR each cell of the grid, top to bottom, left to right:
+ *    a. IF it has a point: skip it
+ *    b. Find its first square that fits, row by row, skipping blocked
+ *       squares a word at a time and, past a square too close to a
+ *       point, every square of the row that is just as close;
+ *       IF none: skip the cell
+ *    c. Add that square as a point and make it active
+ *    d. WHILE there are active points:
+ *       - Pick one at random
+ *       - Try up to ATTEMPTS random squares between spacing and twice
+ *         spacing away from it; add the first that fits as an active point
+ *       - IF none fit: it stops being active
+ * 3. Every square is now blocked, a point, or too close to one
+ *
+ * Each point is tried from a bounded number of times and each row of a
+ * cell scanned once, so the time is linear in the squares of the board.
+ *
+ * @param spacing Least distance between two points (straight line)
+ * @param random Random stream the points are drawn from
+ * @param points Set to the points, in the order they were found
+ */
+void SpawnSampler::sample(int spacing, GameRandom& random, vector<Position>& points) {
+    points.clear();
+    active.clear();
+    spacing = max(1, spacing);
+    // Widest cell two of whose squares are closer than spacing: (cell - 1) * sqrt(2) < spacing
+    int cell = 1;
+    while (2LL * cell * cell < (long long)spacing * spacing) cell++;
+    int reach = (spacing + cell - 2) / cell;
+    int gridRows = (height + cell - 1) / cell;
+    int gridColumns = (width + cell - 1) / cell;
+    grid.assign((size_t)gridRows * gridColumns, -1);
+    long long minimum = (long long)spacing * spacing;
+
+    // A point closer than spacing to the square (-1: none)
+    auto closePoint = [&](int row, int column) {
+        int cellRow = row / cell;
+        int cellColumn = column / cell;
+        int lastRow = min(gridRows - 1, cellRow + reach);
+        int lastColumn = min(gridColumns - 1, cellColumn + reach);
+        for (int r = max(0, cellRow - reach); r <= lastRow; r++) {
+            const int32_t* line = &grid[(size_t)r * gridColumns];
+            for (int c = max(0, cellColumn - reach); c <= lastColumn; c++) {
+                if (line[c] < 0) continue;
+                long long dRow = points[line[c]].row - row;
+                long long dColumn = points[line[c]].column - column;
+                if (dRow * dRow + dColumn * dColumn < minimum) return line[c];
+            }
+        }
+        return -1;
+    };
+    auto fits = [&](int row, int column) {
+        return row >= 0 && row < height && column >= 0 && column < width &&
+               !isBlocked(row, column) && closePoint(row, column) < 0;
+    };
+    auto add = [&](int row, int column) {
+        grid[(size_t)(row / cell) * gridColumns + column / cell] = (int32_t)points.size();
+        active.push_back((uint32_t)points.size());
+        points.push_back({row, column});
+    };
+    auto grow = [&]() {
+        while (!active.empty()) {
+            size_t pick = random.nextInt((int)active.size());
+            Position from = points[active[pick]];
+            bool added = false;
+            for (int attempt = 0; attempt < ATTEMPTS && !added; attempt++) {
+                int dRow = random.nextInt(4 * spacing + 1) - 2 * spacing;
+                int dColumn = random.nextInt(4 * spacing + 1) - 2 * spacing;
+                long long d = (long long)dRow * dRow + (long long)dColumn * dColumn;
+                if (d < minimum || d >= 4 * minimum) continue;
+                if (fits(from.row + dRow, from.column + dColumn)) {
+                    add(from.row + dRow, from.column + dColumn);
+                    added = true;
+                }
+            }
+            if (!added) {
+                active[pick] = active.back();
+                active.pop_back();
+            }
+        }
+    };
+    // First square of columns [column, end) of a row that fits (-1: none)
+    auto firstFit = [&](int row, int column, int end) {
+        while (column < end) {
+            uint64_t open = ~blocked[(size_t)row * words + column / 64] >> (column % 64);
+            if (!open) {
+                column = (column / 64 + 1) * 64;
+                continue;
+            }
+            while (!(open & 1)) {
+                open >>= 1;
+                column++;
+            }
+            if (column >= end) break;
+            int close = closePoint(row, column);
+            if (close < 0) return column;
+            // Skip the rest of the row inside that point's circle
+            long long dRow = points[close].row - row;
+            long long rest = minimum - 1 - dRow * dRow;
+            column = points[close].column + (int)squareRoot(rest) + 1;
+        }
+        return -1;
+    };
+
+    for (int cellRow = 0; cellRow < gridRows; cellRow++) {
+        for (int cellColumn = 0; cellColumn < gridColumns; cellColumn++) {
+            if (grid[(size_t)cellRow * gridColumns + cellColumn] >= 0) continue;
+            int lastRow = min(height, (cellRow + 1) * cell);
+            int lastColumn = min(width, (cellColumn + 1) * cell);
+            for (int row = cellRow * cell; row < lastRow; row++) {
+                int column = firstFit(row, cellColumn * cell, lastColumn);
+                if (column >= 0) {
+                    add(row, column);
+                    grow();
+                    break;
+                }
+            }
+        }
+    }
+}
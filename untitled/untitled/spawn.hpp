@@ -0,0 +1,134 @@
+/**
+ * @file spawn.hpp
+ * @brief Rules for where enemies and items may be placed, and the sampler that keeps them
+ *
+ * This file contains SpawnRules (how far enemies stay from the start
+ * square, how far apart enemies and items are, the regions items are
+ * spread over) and SpawnSampler, which finds squares that keep them on a
+ * whole board in time linear in its squares rather than by retrying random
+ * squares until one fits:
+ * - keepClear() blocks every square too close to the start square with a
+ *   distance transform: two raster passes give each square its (Manhattan)
+ *   distance to the nearest of any number of squares
+ * - sample() lays Poisson-disk (blue-noise) points over the squares left:
+ *   no two closer than the spacing and no room for another, found by
+ *   growing outwards from points already placed (Bridson's algorithm) with
+ *   a background grid of at most one point per cell, so checking a
+ *   candidate only looks at a few cells
+ * The caller then picks as many of the points as it needs; any pick keeps
+ * the spacing. When it needs only a few, spreadSpacing() widens the
+ * spacing so that few more are laid, spread over the whole board.
+ *
+ * Every distance is compared and every square root taken in integers, so
+ * the same seed gives the same points on every platform.
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "position.hpp"
+#include "random.hpp"
+
+using namespace std;
+
+/**
+ * @struct SpawnRules
+ * @brief Where a board's enemies and items may be placed
+ */
+struct SpawnRules {
+    int startClearance = 4;  ///< No enemy fewer than this many steps from the start square
+    int enemySpacing = 3;    ///< Least distance between two enemies (straight line, in squares)
+    int itemSpacing = 2;     ///< Least distance between two items
+    int regionSize = 64;     ///< Side of the square regions items are spread evenly over
+};
+
+/**
+ * @class SpawnSampler
+ * @brief Blocked bit of every square of a board, and Poisson-disk points over the rest
+ *
+ * Blocked squares are stored like CaveMap's walls (64-bit words per row,
+ * the bits past the last column set), so a cave map can be copied in.
+ */
+class SpawnSampler {
+public:
+    static const int ATTEMPTS = 12;  ///< Candidates sample() tries around a point before it stops growing
+    static const int SPREAD = 4;     ///< Points laid per point needed, with spreadSpacing()
+
+    int width;                  ///< Columns
+    int height;                 ///< Rows
+    int words;                  ///< 64-bit words per row
+    vector<uint64_t> blocked;   ///< Squares no point may be put on, row by row (words per row)
+    vector<uint8_t> distance;   ///< Scratch of keepClear(): steps to the nearest seed (at most 255)
+    vector<int32_t> grid;       ///< Scratch of sample(): point in each background cell (-1: none)
+    vector<uint32_t> active;    ///< Scratch of sample(): points still being grown from
+
+    /**
+     * @brief Constructor, nothing blocked
+     *
+     * @param w Width of the board
+     * @param h Height of the board
+     */
+    SpawnSampler(int w, int h);
+
+    /**
+     * @brief Unblock every square (past the last column aside)
+     */
+    void clear();
+
+    /**
+     * @brief Block every square fewer than radius steps from any of seeds (distance transform)
+     *
+     * @param seeds Squares to keep clear around
+     * @param radius Steps (Manhattan) a square must be from every seed to stay unblocked
+     */
+    void keepClear(const vector<Position>& seeds, int radius);
+
+    /**
+     * @brief Block every square closer than spacing to a point (which may lie off the board)
+     *
+     * @param row Point's row (may be negative or past the last row)
+     * @param column Point's column
+     * @param spacing Distance (straight line) a square must be from the point to stay unblocked
+     */
+    void keepAway(int row, int column, int spacing);
+
+    /**
+     * @brief Lay Poisson-disk points over the unblocked squares
+     *
+     * @param spacing Least distance between two points (straight line)
+     * @param random Random stream the points are drawn from
+     * @param points Set to the points, in the order they were found
+     */
+    void sample(int spacing, GameRandom& random, vector<Position>& points);
+
+    /**
+     * @brief Spacing that lays about SPREAD points per point needed over a board (at least least)
+     *
+     * @param least Smallest spacing allowed
+     * @param squares Squares of the board
+     * @param needed Points the caller will pick
+     */
+    static int spreadSpacing(int least, long long squares, size_t needed);
+
+    /**
+     * @brief Check whether a square is blocked
+     */
+    bool isBlocked(int row, int column) const {
+        return (blocked[(size_t)row * words + column / 64] >> (column % 64)) & 1;
+    }
+
+    /**
+     * @brief Block a square
+     */
+    void block(int row, int column) {
+        blocked[(size_t)row * words + column / 64] |= (uint64_t)1 << (column % 64);
+    }
+
+    /**
+     * @brief Bits of the last word of a row that lie past the last column
+     */
+    uint64_t paddingMask() const {
+        return width % 64 ? ~(uint64_t)0 << (width % 64) : 0;
+    }
+};
@@ -0,0 +1,118 @@
+/**
+ * @file spscring.hpp
+ * @brief Lock-free ring buffer between one producer and one consumer thread
+ *
+ * This file contains SpscRing, a fixed-capacity queue that one thread
+ * pushes into and one other thread pops from without locks: each side
+ * owns one index and only reads the other's, with acquire/release ordering
+ * so a slot is fully written before the consumer sees it and fully read
+ * before the producer reuses it. The event writer thread (events.hpp) uses
+ * it to take events off the game thread.
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class SpscRing
+ * @brief Single-producer/single-consumer lock-free queue of T
+ *
+ * tryPush() may only be called from one thread and tryPop()/popMany()
+ * from one other. The indexes count up forever and are masked into the
+ * slots, so full (tail - head == capacity) and empty (tail == head) are
+ * told apart without a spare slot. Each side also keeps a cached copy of
+ * the other side's index and only reloads it when the cached one says
+ * full (or empty), so the two cache lines are not passed back and forth
+ * on every call.
+ */
+template <typename T>
+class SpscRing {
+public:
+    vector<T> slots;   ///< Storage (size is a power of two)
+    size_t mask;       ///< slots.size() - 1
+
+    alignas(64) atomic<size_t> head{0};  ///< Next slot to pop (written by the consumer)
+    size_t cachedTail = 0;               ///< Consumer's last look at tail
+
+    alignas(64) atomic<size_t> tail{0};  ///< Next slot to push (written by the producer)
+    size_t cachedHead = 0;               ///< Producer's last look at head
+
+    /**
+     * @brief Constructor
+     *
+     * @param capacity Items the ring holds (rounded up to a power of two)
+     */
+    SpscRing(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Add an item (producer thread only)
+     *
+     * @return false if the ring is full
+     */
+    bool tryPush(const T& item) {
+        size_t at = tail.load(memory_order_relaxed);
+        if (at - cachedHead == slots.size()) {
+            cachedHead = head.load(memory_order_acquire);
+            if (at - cachedHead == slots.size()) return false;
+        }
+        slots[at & mask] = item;
+        tail.store(at + 1, memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest item (consumer thread only)
+     *
+     * @return false if the ring is empty
+     */
+    bool tryPop(T& item) {
+        size_t at = head.load(memory_order_relaxed);
+        if (at == cachedTail) {
+            cachedTail = tail.load(memory_order_acquire);
+            if (at == cachedTail) return false;
+        }
+        item = slots[at & mask];
+        head.store(at + 1, memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Hand up to max of the oldest items to use, then free their slots (consumer only)
+     *
+     * The items are passed by reference straight from the ring, in order,
+     * and the slots are given back to the producer in one store at the end.
+     *
+     * @param max Most items to take
+     * @param use Called with each item
+     * @return Number of items taken
+     */
+    template <typename Use>
+    size_t popMany(size_t max, Use use) {
+        size_t at = head.load(memory_order_relaxed);
+        cachedTail = tail.load(memory_order_acquire);
+        size_t available = cachedTail - at;
+        if (available > max) available = max;
+        for (size_t i = 0; i < available; i++) use(slots[(at + i) & mask]);
+        head.store(at + available, memory_order_release);
+        return available;
+    }
+
+    /**
+     * @brief Items in the ring (exact only when called from one of the two threads while the other is idle)
+     */
+    size_t size() const {
+        return tail.load(memory_order_acquire) - head.load(memory_order_acquire);
+    }
+};
@@ -0,0 +1,266 @@
+/**
+ * @file terrain.cpp
+ * @brief Growing and connecting the caves of a CaveMap
+ *
+ * @author [Ish Soundankar]
+ */
+#include "terrain.hpp"
+#include <algorithm>
+#include <cstdlib> // abs
+#include "random.hpp"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Mixed into the seed so the walls are not drawn from the chunks' streams
+const uint64_t CAVE_STREAM = 0x43415645;  // "CAVE"
+
+/**
+ * @brief Index of the lowest set bit (bits must not be 0)
+ */
+static int lowestBit(uint64_t bits) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return (int)index;
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+/**
+ * @struct NeighbourCount
+ * @brief Bit-sliced counter: the number of walls around 64 squares at once
+ *
+ * Bit b of ones, twos, fours and eights are the binary digits of the count
+ * for square b; add() is a ripple-carry add of one more neighbour word.
+ */
+struct NeighbourCount {
+    uint64_t ones = 0;    ///< Bit 0 of each count
+    uint64_t twos = 0;    ///< Bit 1 of each count
+    uint64_t fours = 0;   ///< Bit 2 of each count
+    uint64_t eights = 0;  ///< Bit 3 of each count (only 8 reaches it)
+
+    void add(uint64_t neighbours) {
+        uint64_t carry = ones & neighbours;
+        ones ^= neighbours;
+        uint64_t carry2 = twos & carry;
+        twos ^= carry;
+        uint64_t carry4 = fours & carry2;
+        fours ^= carry2;
+        eights |= carry4;
+    }
+
+    /// Squares with at least 4 walls around them
+    uint64_t atLeast4() const { return fours | eights; }
+
+    /// Squares with at least 5 walls around them
+    uint64_t atLeast5() const { return eights | (fours & (twos | ones)); }
+};
+
+/**
+ * @brief Constructor, a map with no walls (past the last column aside)
+ *
+ * @param w Width of the board
+ * @param h Height of the board
+ */
+CaveMap::CaveMap(int w, int h) : width(w), height(h), words((w + 63) / 64) {
+    walls.assign((size_t)height * words, 0);
+    next.assign(walls.size(), 0);
+    uint64_t padding = paddingMask();
+    for (int row = 0; row < height; row++) walls[(size_t)row * words + words - 1] |= padding;
+}
+
+/**
+ * @brief Scatter walls, run STEPS automaton steps and connect the caves
+ *
+ * @param seed Seed the walls are derived from
+ * @param start Square that must be open and reach every other open square
+ */
+void CaveMap::generate(unsigned seed, Position start) {
+    scatter(seed);
+    for (int i = 0; i < STEPS; i++) step();
+    connect(start);
+}
+
+/**
+ * @brief Make each square a wall with probability 7/16, independently
+ *
+ * Pseudo-code:
+ * 1. Derive the cave stream from the seed
+ * 2. FOR each word of the map: a & (b | c | d) of four random words, whose
+ *    bits are each set with probability 1/2 * (1 - 1/8) = 7/16
+ * 3. Keep the bits past the last column set
+ *
+ * @param seed Seed the walls are derived from
+ */
+void CaveMap::scatter(unsigned seed) {
+    GameRandom random(seed);
+    random.state = random.next() ^ CAVE_STREAM;
+    uint64_t padding = paddingMask();
+    for (int row = 0; row < height; row++) {
+        uint64_t* line = &walls[(size_t)row * words];
+        for (int w = 0; w < words; w++) {
+            // One call per statement, so the draws are made in the same order everywhere
+            uint64_t a = random.next();
+            uint64_t b = random.next();
+            uint64_t c = random.next();
+            uint64_t d = random.next();
+            line[w] = a & (b | c | d);
+        }
+        line[words - 1] |= padding;
+    }
+}
+
+/**
+ * @brief One automaton step: wall if 5+ of the 8 neighbours are walls, or 4+ and already one
+ *
+ * Pseudo-code:
+ * 1. FOR each row, FOR each word of it:
+ *    a. Take the word above, the word itself and the word below (all walls
+ *       off the board), each also shifted one column left and right with
+ *       the bit carried in from the word beside it
+ *    b. Add the eight neighbour words into a bit-sliced count
+ *    c. New word = 5+ walls around, or 4+ around and a wall already
+ * 2. Keep the bits past the last column set and swap the new map in
+ *
+ * Every word's new value only depends on the old map, so the result does
+ * not depend on the order the words are visited in.
+ */
+void CaveMap::step() {
+    const uint64_t solid = ~(uint64_t)0;
+    uint64_t padding = paddingMask();
+    for (int row = 0; row < height; row++) {
+        const uint64_t* above = row > 0 ? &walls[(size_t)(row - 1) * words] : nullptr;
+        const uint64_t* here = &walls[(size_t)row * words];
+        const uint64_t* below = row + 1 < height ? &walls[(size_t)(row + 1) * words] : nullptr;
+        uint64_t* out = &next[(size_t)row * words];
+
+        // Word w of a row, or solid wall off the board
+        auto word = [&](const uint64_t* line, int w) {
+            return line && w >= 0 && w < words ? line[w] : solid;
+        };
+        for (int w = 0; w < words; w++) {
+            NeighbourCount count;
+            for (const uint64_t* line : {above, here, below}) {
+                uint64_t middle = word(line, w);
+                uint64_t west = (middle << 1) | (word(line, w - 1) >> 63);  // Column - 1 moved into each bit
+                uint64_t east = (middle >> 1) | (word(line, w + 1) << 63);  // Column + 1 moved into each bit
+                if (line != here) count.add(middle);
+                count.add(west);
+                count.add(east);
+            }
+            out[w] = count.atLeast5() | (here[w] & count.atLeast4());
+        }
+        out[words - 1] |= padding;
+    }
+    walls.swap(next);
+}
+
+/**
+ * @brief Collect the runs of open squares into runs
+ *
+ * Pseudo-code:
+ * 1. FOR each row, FOR each word of it (open = not wall):
+ *    a. Starts = open squares whose left neighbour is not open, ends = open
+ *       squares whose right neighbour is not open (looking into the words
+ *       beside it at the edges)
+ *    b. Take starts and ends lowest bit first: a start opens a run, an end
+ *       closes it (a run may span several words)
+ *
+ * @param rowStarts Set to the index of each row's first run (height + 1 entries)
+ */
+void CaveMap::findRuns(vector<size_t>& rowStarts) {
+    runs.clear();
+    rowStarts.assign((size_t)height + 1, 0);
+    for (int row = 0; row < height; row++) {
+        rowStarts[row] = runs.size();
+        const uint64_t* line = &walls[(size_t)row * words];
+        int first = 0;
+        for (int w = 0; w < words; w++) {
+            uint64_t open = ~line[w];
+            uint64_t openLeft = w > 0 ? ~line[w - 1] >> 63 : 0;            // Column before bit 0
+            uint64_t openRight = w + 1 < words ? ~line[w + 1] << 63 : 0;   // Column after bit 63
+            uint64_t starts = open & ~((open << 1) | openLeft);
+            uint64_t ends = open & ~((open >> 1) | openRight);
+            while (starts | ends) {
+                // A run starting and ending on the same square has both bits set: start first
+                int start = starts ? lowestBit(starts) : 64;
+                int end = ends ? lowestBit(ends) : 64;
+                if (start <= end && starts) {
+                    first = w * 64 + start;
+                    starts &= starts - 1;
+                } else {
+                    uint32_t index = (uint32_t)runs.size();
+                    runs.push_back({row, first, w * 64 + end, index});
+                    ends &= ends - 1;
+                }
+            }
+        }
+    }
+    rowStarts[height] = runs.size();
+}
+
+/**
+ * @brief Fill in every cave but the largest and dig a corridor from start to it
+ *
+ * Pseudo-code:
+ * 1. Collect the runs of open squares
+ * 2. FOR each pair of rows: walk both rows' runs together and join every
+ *    two that share a column (squares above each other are connected)
+ * 3. Add up the squares of each cave (union-find root); the largest wins
+ *    (the first found of equal ones)
+ * 4. Make everything wall, then open the runs of the largest cave, finding
+ *    its square closest to start on the way
+ * 5. Dig a corridor from start along its row to that square's column, then
+ *    along the column to the square (just start if the map had no cave)
+ *
+ * @param start Square that must be open and reach every other open square
+ */
+void CaveMap::connect(Position start) {
+    vector<size_t> rowStarts;
+    findRuns(rowStarts);
+
+    for (int row = 1; row < height; row++) {
+        size_t above = rowStarts[row - 1], aboveEnd = rowStarts[row];
+        size_t below = rowStarts[row], belowEnd = rowStarts[row + 1];
+        while (above < aboveEnd && below < belowEnd) {
+            const Run& a = runs[above];
+            const Run& b = runs[below];
+            if (a.first <= b.last && b.first <= a.last) join((uint32_t)above, (uint32_t)below);
+            if (a.last < b.last) above++;
+            else below++;
+        }
+    }
+
+    vector<uint64_t> caveSize(runs.size(), 0);
+    uint32_t largest = 0;
+    for (uint32_t i = 0; i < (uint32_t)runs.size(); i++) {
+        uint32_t cave = root(i);
+        caveSize[cave] += (uint64_t)(runs[i].last - runs[i].first + 1);
+        if (caveSize[cave] > caveSize[largest] || (caveSize[cave] == caveSize[largest] && cave < largest)) {
+            largest = cave;
+        }
+    }
+
+    Position nearest = start;
+    int bestDistance = -1;
+    fill(walls.begin(), walls.end(), ~(uint64_t)0);
+    for (uint32_t i = 0; i < (uint32_t)runs.size(); i++) {
+        const Run& run = runs[i];
+        if (root(i) != largest) continue;
+        for (int column = run.first; column <= run.last; column++) open(run.row, column);
+        int column = min(max(start.column, run.first), run.last);
+        int distance = abs(run.row - start.row) + abs(column - start.column);
+        if (bestDistance < 0 || distance < bestDistance) {
+            bestDistance = distance;
+            nearest = {run.row, column};
+        }
+    }
+
+    int step = nearest.column < start.column ? -1 : 1;
+    for (int column = start.column; column != nearest.column; column += step) open(start.row, column);
+    step = nearest.row < start.row ? -1 : 1;
+    for (int row = start.row; row != nearest.row; row += step) open(row, nearest.column);
+    open(nearest.row, nearest.column);
+}
@@ -0,0 +1,140 @@
+/**
+ * @file terrain.hpp
+ * @brief Cave walls for generated boards
+ *
+ * This file contains CaveMap, a bitmap with one bit per square of a whole
+ * board (set = wall) that is grown into caves by a cellular automaton:
+ * scatter walls at random, then repeatedly turn every square into wall if
+ * enough of its eight neighbours are walls. Rows are stored as 64-bit
+ * words laid out like the chunks' bit rows (word w of a row is chunk
+ * column w, bit b is column b of it), and each step updates 64 squares at
+ * once with shifts and a bit-sliced neighbour count, so a 4096 x 4096
+ * board takes a few milliseconds per step. Finally every cave but the
+ * largest is filled in and a corridor is dug from the start square to it,
+ * so every open square can be walked to from the start. The caves are
+ * found by joining runs of open squares (union-find), row against row,
+ * rather than square by square.
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "position.hpp"
+
+using namespace std;
+
+/**
+ * @class CaveMap
+ * @brief Wall bit of every square of a board, grown into connected caves
+ *
+ * Squares outside the board count as walls; the bits past the last column
+ * of each row are kept set so that they do.
+ */
+class CaveMap {
+public:
+    static const int STEPS = 5;  ///< Automaton steps run by generate()
+
+    int width;               ///< Columns
+    int height;              ///< Rows
+    int words;               ///< 64-bit words per row
+    vector<uint64_t> walls;  ///< Wall bits, row by row (words per row)
+    vector<uint64_t> next;   ///< Scratch the next step is written into
+
+    /**
+     * @struct Run
+     * @brief Open squares next to each other in one row
+     */
+    struct Run {
+        int row;          ///< Row of the run
+        int first;        ///< First column
+        int last;         ///< Last column
+        uint32_t parent;  ///< Union-find parent (index into runs; itself for a root)
+    };
+
+    vector<Run> runs;  ///< Runs of open squares, row by row, left to right
+
+    /**
+     * @brief Constructor, a map with no walls (past the last column aside)
+     *
+     * @param w Width of the board
+     * @param h Height of the board
+     */
+    CaveMap(int w, int h);
+
+    /**
+     * @brief Scatter walls, run STEPS automaton steps and connect the caves
+     *
+     * @param seed Seed the walls are derived from
+     * @param start Square that must be open and reach every other open square
+     */
+    void generate(unsigned seed, Position start);
+
+    /**
+     * @brief Make each square a wall with probability 7/16, independently
+     *
+     * @param seed Seed the walls are derived from
+     */
+    void scatter(unsigned seed);
+
+    /**
+     * @brief One automaton step: wall if 5+ of the 8 neighbours are walls, or 4+ and already one
+     */
+    void step();
+
+    /**
+     * @brief Fill in every cave but the largest and dig a corridor from start to it
+     *
+     * @param start Square that must be open and reach every other open square
+     */
+    void connect(Position start);
+
+    /**
+     * @brief Check whether a square is a wall
+     */
+    bool isWall(int row, int column) const {
+        return (walls[(size_t)row * words + column / 64] >> (column % 64)) & 1;
+    }
+
+    /**
+     * @brief Make a square open
+     */
+    void open(int row, int column) {
+        walls[(size_t)row * words + column / 64] &= ~((uint64_t)1 << (column % 64));
+    }
+
+    /**
+     * @brief Bits of the last word of a row that lie past the last column
+     */
+    uint64_t paddingMask() const {
+        return width % 64 ? ~(uint64_t)0 << (width % 64) : 0;
+    }
+
+    /**
+     * @brief Collect the runs of open squares into runs
+     *
+     * @param rowStarts Set to the index of each row's first run (height + 1 entries)
+     */
+    void findRuns(vector<size_t>& rowStarts);
+
+    /**
+     * @brief Union-find root of a run (halving the path on the way)
+     */
+    uint32_t root(uint32_t run) {
+        while (runs[run].parent != run) {
+            runs[run].parent = runs[runs[run].parent].parent;
+            run = runs[run].parent;
+        }
+        return run;
+    }
+
+    /**
+     * @brief Put two runs in the same cave (the lower root index stays the root)
+     */
+    void join(uint32_t a, uint32_t b) {
+        a = root(a);
+        b = root(b);
+        if (a < b) runs[b].parent = a;
+        else if (b < a) runs[a].parent = b;
+    }
+};
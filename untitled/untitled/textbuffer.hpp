@@ -0,0 +1,111 @@
+/**
+ * @file textbuffer.hpp
+ * @brief Formatting text into a buffer and writing it out in one go
+ *
+ * This file contains TextBuffer, which formats strings and integers (with
+ * std::to_chars, no locale or stream state involved) into memory supplied
+ * by the caller and writes everything to a stream with a single write()
+ * when flushed, and TextLine, a TextBuffer with its own fixed-size array
+ * for the common case of one line on the stack. printStats() and
+ * Item::print() format through it instead of chaining << and endl.
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include "output.hpp"
+
+using namespace std;
+
+/**
+ * @class TextBuffer
+ * @brief Text formatted into caller-supplied memory, written out on flush()
+ *
+ * If the memory fills up, what is there so far is written to the stream
+ * and formatting carries on from the start, so long text (a long player
+ * name) is never cut off, it just takes more than one write.
+ */
+class TextBuffer {
+public:
+    char* data;        ///< Caller's memory
+    size_t capacity;   ///< Bytes of data
+    size_t length = 0; ///< Bytes formatted and not yet written
+    ostream& out;      ///< Where flush() writes
+
+    /**
+     * @brief Constructor
+     *
+     * @param buffer Memory to format into
+     * @param size Bytes of buffer (at least 32, enough for any integer)
+     * @param stream Stream the text is written to
+     */
+    TextBuffer(char* buffer, size_t size, ostream& stream) : data(buffer), capacity(size), out(stream) {}
+    TextBuffer(const TextBuffer&) = delete;
+    TextBuffer& operator=(const TextBuffer&) = delete;
+
+    /**
+     * @brief Destructor writes whatever is left
+     */
+    ~TextBuffer() { flush(); }
+
+    /**
+     * @brief Write the formatted text to the stream with one write() and start over
+     */
+    void flush() {
+        if (length > 0) out.write(data, (streamsize)length);
+        length = 0;
+    }
+
+    TextBuffer& operator<<(string_view text) {
+        while (length + text.size() > capacity) {
+            size_t fits = capacity - length;
+            memcpy(data + length, text.data(), fits);
+            length = capacity;
+            text.remove_prefix(fits);
+            flush();
+        }
+        memcpy(data + length, text.data(), text.size());
+        length += text.size();
+        return *this;
+    }
+
+    TextBuffer& operator<<(const char* text) { return *this << string_view(text); }
+    TextBuffer& operator<<(const string& text) { return *this << string_view(text); }
+
+    TextBuffer& operator<<(char c) {
+        if (length == capacity) flush();
+        data[length++] = c;
+        return *this;
+    }
+
+    TextBuffer& operator<<(int value) {
+        if (capacity - length < 16) flush();
+        length = (size_t)(to_chars(data + length, data + capacity, value).ptr - data);
+        return *this;
+    }
+};
+
+/**
+ * @class TextLine
+ * @brief TextBuffer with its own Size-byte array, normally one line on the stack
+ */
+template <size_t Size>
+class TextLine : public TextBuffer {
+public:
+    char storage[Size];  ///< The memory formatted into
+
+    /**
+     * @brief Constructor
+     *
+     * @param stream Stream the line is written to (the game's output unless given)
+     */
+    TextLine(ostream& stream = gameOut()) : TextBuffer(storage, Size, stream) {}
+
+    /**
+     * @brief Destructor writes the line (while storage is still alive)
+     */
+    ~TextLine() { flush(); }
+};
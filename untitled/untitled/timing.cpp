@@ -0,0 +1,73 @@
+/**
+ * @file timing.cpp
+ * @brief Implementation of histogram percentiles and the timing report
+ *
+ * @author [Ish Soundankar]
+ */
+#include "timing.hpp"
+#include <iomanip>
+
+/**
+ * @brief Short name of a phase for reports
+ */
+const char* phaseName(int phase) {
+    static const char* names[PHASE_COUNT] = {
+        "input", "logic", "day/night", "journal", "clear", "stats", "render", "paging", "batch"
+    };
+    return phase >= 0 && phase < PHASE_COUNT ? names[phase] : "other";
+}
+
+/**
+ * @brief Value at or below which a fraction of the values fall
+ *
+ * Pseudo-code:
+ * 1. Work out how many values lie at or below the wanted rank
+ * 2. Walk the buckets adding up counts until that many are passed
+ * 3. RETURN the top of that bucket (never above the largest value)
+ *
+ * @param fraction 0.5 for the median, 0.99 for the 99th percentile, ...
+ * @return Top of the bucket holding that value (0 if nothing recorded)
+ */
+uint64_t LatencyHistogram::percentile(double fraction) const {
+    if (count == 0) return 0;
+    uint64_t rank = (uint64_t)(fraction * count + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            uint64_t top = bucketTop(bucket);
+            return top < max ? top : max;
+        }
+    }
+    return max;
+}
+
+/**
+ * @brief Print count, mean, percentiles and maximum of every phase
+ *
+ * Phases that never ran are left out. Times are in microseconds.
+ *
+ * @param out Stream to print to
+ */
+void TurnTimings::report(ostream& out) const {
+    out << "Turn phase timings (microseconds)" << endl;
+    out << left << setw(10) << "phase" << right << setw(9) << "count" << setw(10) << "mean"
+        << setw(10) << "p50" << setw(10) << "p90" << setw(10) << "p99" << setw(10) << "p99.9"
+        << setw(10) << "max" << endl;
+    out << fixed << setprecision(1);
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        const LatencyHistogram& h = phases[phase];
+        if (h.count == 0) continue;
+        out << left << setw(10) << phaseName(phase) << right << setw(9) << h.count
+            << setw(10) << h.total / 1000.0 / h.count
+            << setw(10) << h.percentile(0.5) / 1000.0
+            << setw(10) << h.percentile(0.9) / 1000.0
+            << setw(10) << h.percentile(0.99) / 1000.0
+            << setw(10) << h.percentile(0.999) / 1000.0
+            << setw(10) << h.max / 1000.0 << endl;
+    }
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+}
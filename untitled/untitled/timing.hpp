@@ -0,0 +1,213 @@
+/**
+ * @file timing.hpp
+ * @brief Latency histograms for the phases of a turn
+ *
+ * This file contains the LatencyHistogram class, the TurnTimings table of
+ * one histogram per turn phase, and the TIME_PHASE macro that times the
+ * rest of the enclosing block with the monotonic clock.
+ *
+ * Timing is compiled in only when GAME_TIMING is defined (qmake
+ * CONFIG+=timing). The same phases are used by the allocation counters
+ * (GAME_COUNTERS, qmake CONFIG+=counters). With neither defined,
+ * TIME_PHASE expands to nothing and the game carries no timing code at all.
+ *
+ * @author [Ish Soundankar]
+ */
+#pragma once
+#include <cstdint>
+#include <chrono>
+#include <iostream>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+/**
+ * @enum TimingPhase
+ * @brief Parts of the main loop that are timed separately
+ */
+enum TimingPhase {
+    PHASE_INPUT,      ///< Reading a typed-ahead key
+    PHASE_LOGIC,      ///< playTurn() (includes PHASE_DAY_NIGHT)
+    PHASE_DAY_NIGHT,  ///< Day/night check and sweep of the enemies
+    PHASE_JOURNAL,    ///< Appending the turn to the journal
+    PHASE_CLEAR,      ///< Clearing the screen
+    PHASE_STATS,      ///< Printing the current stats
+    PHASE_RENDER,     ///< Printing the board
+    PHASE_PAGING,     ///< Paging cold chunks out
+    PHASE_BATCH,      ///< A whole batch of commands, from clear to frame
+    PHASE_COUNT       ///< Number of phases
+};
+
+/**
+ * @brief Short name of a phase for reports
+ */
+const char* phaseName(int phase);
+
+/**
+ * @class LatencyHistogram
+ * @brief Log-linear histogram of durations in nanoseconds
+ *
+ * Like an HDR histogram: every power of two is split into 2^SUB_BITS equal
+ * buckets, so any recorded value is known to within 1/32 of itself while
+ * the whole 64-bit range fits in a fixed table. Recording is a few
+ * instructions and never allocates.
+ */
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 5;                                 ///< log2 of buckets per power of two
+    static const int SUB_BUCKETS = 1 << SUB_BITS;                  ///< Buckets per power of two
+    static const int BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;  ///< Buckets in the table
+
+    uint64_t counts[BUCKETS] = {};  ///< Values recorded in each bucket
+    uint64_t count = 0;             ///< Values recorded
+    uint64_t total = 0;             ///< Sum of the values
+    uint64_t min = UINT64_MAX;      ///< Smallest value
+    uint64_t max = 0;               ///< Largest value
+
+    /**
+     * @brief Bucket holding a value
+     */
+    static int bucketOf(uint64_t value) {
+        if (value < (uint64_t)SUB_BUCKETS) return (int)value;
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        int top = (int)index;
+#else
+        int top = 63 - __builtin_clzll(value);
+#endif
+        int shift = top - SUB_BITS;
+        return (shift + 1) * SUB_BUCKETS + (int)((value >> shift) - SUB_BUCKETS);
+    }
+
+    /**
+     * @brief Highest value that falls in a bucket
+     */
+    static uint64_t bucketTop(int bucket) {
+        if (bucket < SUB_BUCKETS) return (uint64_t)bucket;
+        int shift = bucket / SUB_BUCKETS - 1;
+        uint64_t low = (uint64_t)(bucket % SUB_BUCKETS + SUB_BUCKETS) << shift;
+        return low + ((uint64_t)1 << shift) - 1;
+    }
+
+    /**
+     * @brief Add one value
+     *
+     * @param value Duration in nanoseconds
+     */
+    void record(uint64_t value) {
+        counts[bucketOf(value)]++;
+        count++;
+        total += value;
+        if (value < min) min = value;
+        if (value > max) max = value;
+    }
+
+    /**
+     * @brief Value at or below which a fraction of the values fall
+     *
+     * @param fraction 0.5 for the median, 0.99 for the 99th percentile, ...
+     * @return Top of the bucket holding that value (0 if nothing recorded)
+     */
+    uint64_t percentile(double fraction) const;
+};
+
+/**
+ * @class TurnTimings
+ * @brief One latency histogram per turn phase
+ */
+class TurnTimings {
+public:
+    LatencyHistogram phases[PHASE_COUNT];  ///< Histogram of each phase
+
+    /**
+     * @brief Print count, mean, percentiles and maximum of every phase
+     *
+     * @param out Stream to print to
+     */
+    void report(ostream& out) const;
+};
+
+/**
+ * @brief The game's phase timings
+ */
+inline TurnTimings& turnTimings() {
+    static TurnTimings timings;
+    return timings;
+}
+
+#ifdef GAME_COUNTERS
+/**
+ * @brief Make a phase the one allocations are counted against
+ *
+ * @param phase Phase being entered
+ * @return Phase that was current before (for leaveCountedPhase())
+ */
+int enterCountedPhase(int phase);
+
+/**
+ * @brief Go back to the phase that was current before enterCountedPhase()
+ *
+ * @param outer Value enterCountedPhase() returned
+ */
+void leaveCountedPhase(int outer);
+#endif
+
+/**
+ * @class PhaseScope
+ * @brief Marks the time from construction to destruction as one phase
+ *
+ * Timing builds record the elapsed time in the phase's histogram. Counter
+ * builds (GAME_COUNTERS, see counters.hpp) count the heap allocations and
+ * shared_ptr copies made meanwhile against the phase; a nested phase takes
+ * over the counting until it ends.
+ */
+class PhaseScope {
+public:
+    TimingPhase phase;                        ///< Phase being marked
+#ifdef GAME_TIMING
+    chrono::steady_clock::time_point start;   ///< When timing started
+#endif
+#ifdef GAME_COUNTERS
+    int outer;                                ///< Phase counted before this one
+#endif
+
+    /**
+     * @brief Constructor starts the clock and/or the counting
+     *
+     * @param marked Phase to record into
+     */
+    PhaseScope(TimingPhase marked) : phase(marked) {
+#ifdef GAME_COUNTERS
+        outer = enterCountedPhase(phase);
+#endif
+#ifdef GAME_TIMING
+        start = chrono::steady_clock::now();
+#endif
+    }
+
+    /**
+     * @brief Destructor records the elapsed time and restores the outer phase
+     */
+    ~PhaseScope() {
+#ifdef GAME_TIMING
+        auto elapsed = chrono::steady_clock::now() - start;
+        turnTimings().phases[phase].record((uint64_t)chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+#endif
+#ifdef GAME_COUNTERS
+        leaveCountedPhase(outer);
+#endif
+    }
+};
+
+#define TIMING_NAME2(line) phaseScope##line
+#define TIMING_NAME(line) TIMING_NAME2(line)
+
+#if defined(GAME_TIMING) || defined(GAME_COUNTERS)
+/// Mark the rest of the enclosing block as the given phase
+#define TIME_PHASE(phase) PhaseScope TIMING_NAME(__LINE__)(phase)
+#else
+#define TIME_PHASE(phase) ((void)0)
+#endif
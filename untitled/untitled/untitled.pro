@@ -1,18 +1,66 @@
 TEMPLATE = app
-CONFIG += console c++17
+CONFIG += console c++17 thread
 CONFIG -= app_bundle
 CONFIG -= qt
 
 SOURCES += \
         board.cpp \
         characters.cpp \
-        main.cpp
+        counters.cpp \
+        events.cpp \
+        game.cpp \
+        interned.cpp \
+        journal.cpp \
+        keyboard.cpp \
+        main.cpp \
+        pager.cpp \
+        serialize.cpp \
+        snapshot.cpp \
+        spatial.cpp \
+        spawn.cpp \
+        terrain.cpp \
+        timing.cpp
 
 HEADERS += \
     ItemsDB.h \
     board.hpp \
     characters.hpp \
-    items.hpp
+    combat.hpp \
+    counters.hpp \
+    events.hpp \
+    game.hpp \
+    interned.hpp \
+    items.hpp \
+    journal.hpp \
+    keyboard.hpp \
+    nullsink.hpp \
+    output.hpp \
+    pager.hpp \
+    position.hpp \
+    races.hpp \
+    random.hpp \
+    serialize.hpp \
+    snapshot.hpp \
+    spatial.hpp \
+    spawn.hpp \
+    spscring.hpp \
+    terrain.hpp \
+    textbuffer.hpp \
+    timing.hpp
+
+# qmake CONFIG+=timing builds in the turn phase timers (see timing.hpp)
+timing {
+    DEFINES += GAME_TIMING
+}
+
+# qmake CONFIG+=counters counts allocations and shared_ptr copies per
+# turn phase (see counters.hpp)
+counters {
+    DEFINES += GAME_COUNTERS
+}
+
+# The microbenchmarks and the load tester are separate targets:
+# bench/bench.pro and loadtest/loadtest.pro
 
 DISTFILES += \
     Class Design \